@@ -12,7 +12,7 @@ exit_on_error()
 
 # Compile the program with coverage options
 {
-    gcc -Wall -fprofile-arcs -ftest-coverage ../src/main.c -o numconvert_cov
+    gcc -Wall -fprofile-arcs -ftest-coverage ../src/main.c ../src/numconvert.c ../src/shmring.c ../src/range.c ../src/stream.c ../src/layout.c -lrt -pthread -o numconvert_cov
 } &> /dev/null
 rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
 
@@ -46,13 +46,13 @@ rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
 
 # Output the coverage result
 {
-    gcov main.c
+    gcov main.c numconvert.c shmring.c range.c stream.c layout.c
 } &> /dev/null
 rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
 
 # Create gcov files
 {
-    gcov -abcfu main.c
+    gcov -abcfu main.c numconvert.c shmring.c range.c stream.c layout.c
 } &> /dev/null
 rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
 
@@ -0,0 +1,39 @@
+#!/bin/bash
+# Measure the per request round-trip latency of the shared-memory ring mode (numconvert --shm).
+# The script will handle up to 1 argument, the number of measured requests.
+
+exit_on_error()
+{
+    arg1=$1
+
+    echo "Failed to execute with error "$arg1". Exiting..."
+    exit $arg1
+}
+
+# Store the first argument into COUNT because that is the number of requests we measure
+COUNT="$1"
+SHM_NAME="/numconvert_bench_$$"
+
+# Compile the program and the benchmark with release options
+{
+    gcc -Wall -O3 ../src/main.c ../src/numconvert.c ../src/shmring.c ../src/range.c ../src/stream.c ../src/layout.c -lrt -pthread -o numconvert_lat
+} &> /dev/null
+rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+{
+    gcc -Wall -O3 -I../src shmring_bench.c -lrt -o shmring_bench
+} &> /dev/null
+rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+
+# Serve the ring in the background, the benchmark stops it when done
+./numconvert_lat --shm $SHM_NAME &
+SERVER_PID=$!
+
+./shmring_bench $SHM_NAME $COUNT
+rc=$?; if [[ $rc != 0 ]]; then kill $SERVER_PID &> /dev/null; exit_on_error $rc; fi
+
+wait $SERVER_PID
+rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+
+echo "Script completed."
+
+exit 0
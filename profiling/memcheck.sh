@@ -16,7 +16,7 @@ NUMBER="$1"
 
 # Compile the program with profiling options
 {
-    gcc -Wall -O0 -g ../src/main.c -o numconvert_prof
+    gcc -Wall -O0 -g ../src/main.c ../src/numconvert.c ../src/shmring.c ../src/range.c ../src/stream.c ../src/layout.c -lrt -pthread -o numconvert_prof
 } &> /dev/null
 rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
 
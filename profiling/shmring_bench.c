@@ -0,0 +1,324 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shmring.h"
+
+#define REQUEST_COUNT_DEFAULT       1000000u
+#define WARMUP_COUNT                10000u
+#define ATTACH_RETRIES              500u
+#define ATTACH_RETRY_DELAY_NS       10000000l
+#define POLLS_BEFORE_YIELD          1024u
+
+#define HISTOGRAM_SUB_BUCKET_BITS   3u
+#define HISTOGRAM_SUB_BUCKETS       (1u << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKETS           (64u * HISTOGRAM_SUB_BUCKETS)
+
+/*!
+ * \brief A benchmark request with its expected outcome.
+ */
+typedef struct {
+    const char *token;  /*!< The numeric string or NULL to submit number. */
+    uint64_t number;    /*!< The expected (or submitted) number. */
+    char base;          /*!< The requested output base. */
+} BenchRequest;
+
+static const BenchRequest BenchRequests[] = {
+    { "0x12345678", 0x12345678ull, 'd' },
+    { "18446744073709551615", 18446744073709551615ull, 'h' },
+    { "0110000101001110b", 0x614eull, 'd' },
+    { "AbCdEH", 0xabcdeull, 'b' },
+    { NULL, 42ull, 'h' },
+    { NULL, 0x8000000000000000ull, 'd' },
+    { NULL, 12345678ull, 'b' },
+};
+
+#define BENCH_REQUEST_COUNT (sizeof(BenchRequests) / sizeof(BenchRequests[0]))
+
+static uint64_t Histogram[HISTOGRAM_BUCKETS];
+
+/*!
+ * \brief Return a monotonic timestamp.
+ * \returns
+ *      The timestamp in nanoseconds.
+ */
+static uint64_t Now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/*!
+ * \brief Determine the histogram bucket of a latency.
+ * \details
+ *      Log-linear buckets: every power of 2 is split into HISTOGRAM_SUB_BUCKETS equal parts, which
+ *      bounds the reporting error to 12.5%.
+ * \param ns
+ *      The latency in nanoseconds.
+ * \returns
+ *      The bucket index.
+ */
+static uint32_t BucketIndex(uint64_t ns)
+{
+    uint32_t exponent = 0;
+
+    if (ns < HISTOGRAM_SUB_BUCKETS) {
+        return (uint32_t)ns;
+    }
+
+    exponent = 63u - (uint32_t)__builtin_clzll(ns);
+
+    return ((exponent - HISTOGRAM_SUB_BUCKET_BITS + 1u) * HISTOGRAM_SUB_BUCKETS) +
+           (uint32_t)((ns >> (exponent - HISTOGRAM_SUB_BUCKET_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1u));
+}
+
+/*!
+ * \brief Determine the largest latency that falls into a histogram bucket.
+ * \param index
+ *      The bucket index.
+ * \returns
+ *      The latency in nanoseconds.
+ */
+static uint64_t BucketUpperBound(uint32_t index)
+{
+    uint32_t shift = 0;
+    uint64_t lower = 0;
+
+    if (index < HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+
+    shift = (index / HISTOGRAM_SUB_BUCKETS) - 1u;
+    lower = (uint64_t)(HISTOGRAM_SUB_BUCKETS + (index % HISTOGRAM_SUB_BUCKETS)) << shift;
+
+    return lower + ((uint64_t)1 << shift) - 1u;
+}
+
+/*!
+ * \brief Determine the latency at a percentile.
+ * \param count
+ *      The total number of recorded latencies.
+ * \param percentile
+ *      The percentile, between 0 and 100.
+ * \returns
+ *      The upper bound of the bucket that holds the percentile, in nanoseconds.
+ */
+static uint64_t Percentile(uint64_t count, double percentile)
+{
+    uint64_t target = (uint64_t)((percentile / 100.0) * (double)count);
+    uint64_t cumulative = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        cumulative += Histogram[i];
+        if ((cumulative > target) || (cumulative == count)) {
+            break;
+        }
+    }
+
+    return BucketUpperBound(i);
+}
+
+/*!
+ * \brief Map the shared-memory ring that numconvert --shm serves.
+ * \param name
+ *      The POSIX shared-memory object name.
+ * \returns
+ *      The ready to use ring or NULL in case of an error.
+ */
+static ShmRing* Attach(const char *name)
+{
+    struct timespec delay = { 0, ATTACH_RETRY_DELAY_NS };
+    struct stat st;
+    ShmRing *ring = NULL;
+    uint32_t i = 0;
+    int fd = -1;
+
+    /* numconvert may still be starting, wait for it to create and initialize the ring. */
+    for (i = 0; i < ATTACH_RETRIES; i++) {
+        if (fd < 0) {
+            fd = shm_open(name, O_RDWR, 0);
+        }
+        if ((fd >= 0) && (ring == NULL) &&
+            (fstat(fd, &st) == 0) && ((size_t)st.st_size >= sizeof(ShmRing))) {
+            ring = mmap(NULL, sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (ring == MAP_FAILED) {
+                ring = NULL;
+                break;
+            }
+        }
+        if ((ring != NULL) && (ShmRingIsReady(ring) == true)) {
+            (void)close(fd);
+            return ring;
+        }
+        (void)nanosleep(&delay, NULL);
+    }
+
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+
+    return NULL;
+}
+
+/*!
+ * \brief Submit a request and busy-wait for its response.
+ * \param ring
+ *      The attached ring.
+ * \param request
+ *      The request to submit.
+ * \param[out] response
+ *      The received response.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int RoundTrip(ShmRing *ring, const BenchRequest *request, ShmRingResponse *response)
+{
+    uint64_t ticket = 0;
+    uint32_t polls = 0;
+    int retval = 0;
+
+    if (request->token != NULL) {
+        retval = ShmRingSubmitToken(ring, request->token, strlen(request->token), request->base,
+                                    &ticket);
+    } else {
+        retval = ShmRingSubmitNumber(ring, request->number, request->base, &ticket);
+    }
+
+    if (retval == 0) {
+        /* Busy-wait, but let numconvert run when it shares our CPU. */
+        while (ShmRingPoll(ring, ticket, response) == false) {
+            polls++;
+            if (polls >= POLLS_BEFORE_YIELD) {
+                polls = 0;
+                (void)sched_yield();
+            }
+        }
+
+        if ((response->status != 0) || (response->number != request->number)) {
+            retval = -1;
+        }
+    }
+
+    return retval;
+}
+
+/*!
+ * \brief This is the program entry.
+ * \details
+ *      Measure the per request round-trip latency of numconvert --shm <name>.
+ *
+ *      Expected arguments:
+ *          argv[1] is the shared-memory object name, f.e. "/numconvert_bench"
+ *          argv[2] is the optional number of measured requests
+ * \param argc
+ *      The number of string pointed to by argv (argument count).
+ * \param argv
+ *      A list of strings (argument vector).
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int main(int argc, char *argv[])
+{
+    ShmRingResponse response;
+    ShmRing *ring = NULL;
+    uint64_t count = REQUEST_COUNT_DEFAULT;
+    uint64_t start = 0;
+    uint64_t total = 0;
+    uint64_t latency = 0;
+    uint64_t maxLatency = 0;
+    uint64_t i = 0;
+    uint32_t j = 0;
+
+    if ((argc != 2) && (argc != 3)) {
+        printf("Usage:\n  shmring_bench <name> [count]\n");
+        return -1;
+    }
+
+    if (argc == 3) {
+        count = strtoull(argv[2], NULL, 10);
+        if (count == 0) {
+            printf("invalid request count\n");
+            return -1;
+        }
+    }
+
+    ring = Attach(argv[1]);
+    if (ring == NULL) {
+        printf("unable to attach to %s\n", argv[1]);
+        return -1;
+    }
+
+    for (i = 0; i < WARMUP_COUNT; i++) {
+        if (RoundTrip(ring, &BenchRequests[i % BENCH_REQUEST_COUNT], &response) != 0) {
+            printf("unexpected response during warmup\n");
+            ShmRingStop(ring);
+            return -1;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        start = Now();
+        if (RoundTrip(ring, &BenchRequests[i % BENCH_REQUEST_COUNT], &response) != 0) {
+            printf("unexpected response for request %llu\n", (unsigned long long)i);
+            ShmRingStop(ring);
+            return -1;
+        }
+        latency = Now() - start;
+
+        Histogram[BucketIndex(latency)]++;
+        total += latency;
+        if (latency > maxLatency) {
+            maxLatency = latency;
+        }
+    }
+
+    ShmRingStop(ring);
+
+    printf("Requests: %llu\n", (unsigned long long)count);
+    printf("Mean:     %llu ns\n", (unsigned long long)(total / count));
+    printf("p50:      %llu ns\n", (unsigned long long)Percentile(count, 50.0));
+    printf("p90:      %llu ns\n", (unsigned long long)Percentile(count, 90.0));
+    printf("p99:      %llu ns\n", (unsigned long long)Percentile(count, 99.0));
+    printf("p99.9:    %llu ns\n", (unsigned long long)Percentile(count, 99.9));
+    printf("Max:      %llu ns\n", (unsigned long long)maxLatency);
+
+    printf("\nHistogram (<= ns: count):\n");
+    for (j = 0; j < HISTOGRAM_BUCKETS; j++) {
+        if (Histogram[j] != 0) {
+            printf("  %10llu: %llu\n", (unsigned long long)BucketUpperBound(j),
+                   (unsigned long long)Histogram[j]);
+        }
+    }
+
+    return 0;
+}
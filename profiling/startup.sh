@@ -0,0 +1,56 @@
+#!/bin/bash
+# Compare the per invocation fork + exec + exit latency of the Release build and the startup
+# optimized build (NUMCONVERT_STARTUP_OPTIMIZED) for representative one-shot invocations.
+# The script will handle up to 1 argument, the number of measured runs per invocation.
+
+exit_on_error()
+{
+    arg1=$1
+
+    echo "Failed to execute with error "$arg1". Exiting..."
+    exit $arg1
+}
+
+# Store the first argument into COUNT because that is the number of runs we measure
+COUNT="$1"
+if [[ -z "$COUNT" ]]; then
+    COUNT=2000
+fi
+
+# Build both variants and the benchmark
+{
+    mkdir -p build_release && cd build_release
+    cmake -D CMAKE_BUILD_TYPE=Release -D NUMCONVERT_STARTUP_OPTIMIZED=OFF ../.. && make && cd ..
+} &> /dev/null
+rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+{
+    mkdir -p build_startup && cd build_startup
+    cmake -D CMAKE_BUILD_TYPE=Release -D NUMCONVERT_STARTUP_OPTIMIZED=ON ../.. && make && cd ..
+} &> /dev/null
+rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+{
+    gcc -Wall -O3 startup_bench.c -o startup_bench
+} &> /dev/null
+rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+
+# A decimal, hexadecimal and binary conversion, a conversion with separators and the help menu
+INVOCATIONS=(
+    "18446744073709551615"
+    "0xdeadbeef"
+    "1010b"
+    "--separators _ 0xdead_beef"
+    "invalid"
+)
+
+for INVOCATION in "${INVOCATIONS[@]}"; do
+    for VARIANT in release startup; do
+        echo "numconvert $INVOCATION ($VARIANT):"
+        ./startup_bench $COUNT build_$VARIANT/numconvert $INVOCATION
+        rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+        echo ""
+    done
+done
+
+echo "Script completed."
+
+exit 0
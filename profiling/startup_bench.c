@@ -0,0 +1,176 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define RUN_COUNT_DEFAULT           2000u
+#define WARMUP_COUNT                50u
+
+/*!
+ * \brief Return a monotonic timestamp.
+ * \returns
+ *      The timestamp in nanoseconds.
+ */
+static uint64_t Now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/*!
+ * \brief Compare two latencies for qsort().
+ * \param a
+ *      The first latency.
+ * \param b
+ *      The second latency.
+ * \returns
+ *      A negative value, 0 or a positive value when a is smaller than, equal to or larger than b.
+ */
+static int CompareLatencies(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*!
+ * \brief Run a program once and wait for it to exit.
+ * \param argv
+ *      The program and its arguments, NULL terminated.
+ * \param devNull
+ *      A file descriptor of /dev/null, it replaces the stdout of the program.
+ * \param[out] status
+ *      The exit status of the program.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int Run(char *argv[], int devNull, int *status)
+{
+    pid_t pid = 0;
+    int waitStatus = 0;
+
+    pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+
+    if (pid == 0) {
+        (void)dup2(devNull, STDOUT_FILENO);
+        (void)execv(argv[0], argv);
+        _exit(127);
+    }
+
+    if ((waitpid(pid, &waitStatus, 0) != pid) || (WIFEXITED(waitStatus) == 0)) {
+        return -1;
+    }
+
+    *status = WEXITSTATUS(waitStatus);
+
+    return 0;
+}
+
+/*!
+ * \brief This is the program entry.
+ * \details
+ *      Measure the fork + exec + exit latency of a program, as seen by a calling script.
+ *
+ *      Expected arguments:
+ *          argv[1] is the number of measured runs, f.e. "2000"
+ *          argv[2] is the program, f.e. "./numconvert"
+ *          argv[3...] are the program arguments, f.e. "0x12"
+ * \param argc
+ *      The number of string pointed to by argv (argument count).
+ * \param argv
+ *      A list of strings (argument vector).
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int main(int argc, char *argv[])
+{
+    uint64_t *latencies = NULL;
+    uint64_t count = RUN_COUNT_DEFAULT;
+    uint64_t start = 0;
+    uint64_t total = 0;
+    uint64_t i = 0;
+    int expectedStatus = 0;
+    int status = 0;
+    int devNull = -1;
+
+    if (argc < 3) {
+        printf("Usage:\n  startup_bench <count> <program> [arguments]\n");
+        return -1;
+    }
+
+    count = strtoull(argv[1], NULL, 10);
+    if (count == 0) {
+        printf("invalid run count\n");
+        return -1;
+    }
+
+    latencies = malloc(count * sizeof(*latencies));
+    devNull = open("/dev/null", O_WRONLY);
+    if ((latencies == NULL) || (devNull < 0)) {
+        printf("out of resources\n");
+        return -1;
+    }
+
+    /* Warm up the page cache, every run must exit with the same status. */
+    for (i = 0; i < WARMUP_COUNT; i++) {
+        if ((Run(&argv[2], devNull, &status) != 0) || ((i > 0) && (status != expectedStatus))) {
+            printf("unable to run %s\n", argv[2]);
+            return -1;
+        }
+        expectedStatus = status;
+    }
+
+    for (i = 0; i < count; i++) {
+        start = Now();
+        if ((Run(&argv[2], devNull, &status) != 0) || (status != expectedStatus)) {
+            printf("unexpected exit of run %llu\n", (unsigned long long)i);
+            return -1;
+        }
+        latencies[i] = Now() - start;
+        total += latencies[i];
+    }
+
+    qsort(latencies, count, sizeof(*latencies), CompareLatencies);
+
+    printf("Runs: %llu, exit status %d\n", (unsigned long long)count, expectedStatus);
+    printf("Mean: %llu ns\n", (unsigned long long)(total / count));
+    printf("p50:  %llu ns\n", (unsigned long long)latencies[count / 2u]);
+    printf("p90:  %llu ns\n", (unsigned long long)latencies[(count * 9u) / 10u]);
+    printf("p99:  %llu ns\n", (unsigned long long)latencies[(count * 99u) / 100u]);
+
+    free(latencies);
+    (void)close(devNull);
+
+    return 0;
+}
@@ -0,0 +1,620 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "numconvert.h"
+#include "layout.h"
+
+#define LAYOUT_TOKENS_MAX   3u     /* <name> <bits> [<labels>] */
+#define LAYOUT_BITS_MAX     64u
+#define LAYOUT_CHUNK_SIZE   65536u /* The number of batch input characters read at once. */
+#define LAYOUT_FILE_SIZE_MAX (1024u * 1024u)
+
+/*!
+ * \brief A part of a line, not terminated.
+ */
+typedef struct {
+    const char *string; /*!< The first character. */
+    size_t len;         /*!< The number of characters. */
+} Token;
+
+static bool IsBlank(char c);
+static bool IsNameChar(char c, bool isFirst);
+static size_t SplitLine(const char *line, size_t len, char delimiter, Token *tokens,
+                        size_t tokenCount);
+static int ConvertToken(const Token *token, uint64_t *number);
+static int CompileBits(const Token *token, LayoutField *field);
+static int CompileLabels(const Token *token, LayoutField *field, Layout *layout);
+static int CompileLine(const char *line, size_t len, Layout *layout);
+static size_t DecodeToken(const Layout *layout, const char *separators, const char *token,
+                          size_t len, bool isTooLong, char *buf, int *retval);
+
+/*!
+ * \brief Check a character to be a space or a tab.
+ * \param c
+ *      The character to check.
+ * \returns
+ *      true if the character is a space or a tab, otherwise false.
+ */
+static bool IsBlank(char c)
+{
+    return ((c == ' ') || (c == '\t'));
+}
+
+/*!
+ * \brief Check a character to be allowed in a field name.
+ * \param c
+ *      The character to check.
+ * \param isFirst
+ *      true for the first character of the name, it can not be a digit or a '.'.
+ * \returns
+ *      true if the character is allowed, otherwise false.
+ */
+static bool IsNameChar(char c, bool isFirst)
+{
+    bool isLetter = (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || (c == '_'));
+    bool isOther = (((c >= '0') && (c <= '9')) || (c == '.'));
+
+    return ((isLetter == true) || ((isFirst == false) && (isOther == true)));
+}
+
+/*!
+ * \brief Split a line into tokens.
+ * \param line
+ *      The line to split.
+ * \param len
+ *      The length of the line.
+ * \param delimiter
+ *      The delimiter character, '\0' to split on spaces and tabs.
+ * \param[out] tokens
+ *      The tokens, empty tokens are only possible with a delimiter.
+ * \param tokenCount
+ *      The maximum number of tokens.
+ * \returns
+ *      The number of tokens, tokenCount + 1 in case there are more.
+ */
+static size_t SplitLine(const char *line, size_t len, char delimiter, Token *tokens,
+                        size_t tokenCount)
+{
+    size_t count = 0;
+    size_t i = 0;
+    size_t start = 0;
+
+    while (i <= len) {
+        if (delimiter == '\0') {
+            while ((i < len) && (IsBlank(line[i]) == true)) {
+                i++;
+            }
+            if (i == len) {
+                break;
+            }
+        }
+
+        start = i;
+        while ((i < len) && (line[i] != delimiter) &&
+               ((delimiter != '\0') || (IsBlank(line[i]) == false))) {
+            i++;
+        }
+
+        if (count == tokenCount) {
+            return tokenCount + 1u;
+        }
+        tokens[count].string = &line[start];
+        tokens[count].len = i - start;
+        count++;
+        i++;
+    }
+
+    return count;
+}
+
+/*!
+ * \brief Convert a token the same way a command line value is converted.
+ * \param token
+ *      The token to convert.
+ * \param[out] number
+ *      The number represented by the token.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int ConvertToken(const Token *token, uint64_t *number)
+{
+    return ConvertString(token->string, token->len, number);
+}
+
+/*!
+ * \brief Compile the "<msb>:<lsb>" or "<bit>" token of a field.
+ * \param token
+ *      The bits token.
+ * \param[out] field
+ *      The field, its shift and mask are set.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int CompileBits(const Token *token, LayoutField *field)
+{
+    Token parts[2];
+    char name[LAYOUT_NAME_SIZE];
+    uint64_t msb = 0;
+    uint64_t lsb = 0;
+    size_t count = 0;
+    int len = 0;
+
+    count = SplitLine(token->string, token->len, ':', parts, 2);
+    if ((count < 1u) || (count > 2u) || (ConvertToken(&parts[0], &msb) != 0)) {
+        return -1;
+    }
+
+    lsb = msb;
+    if ((count == 2u) && (ConvertToken(&parts[1], &lsb) != 0)) {
+        return -1;
+    }
+
+    if ((msb >= LAYOUT_BITS_MAX) || (lsb > msb)) {
+        return -1;
+    }
+
+    field->shift = (uint32_t)lsb;
+    field->mask = UINT64_MAX >> (LAYOUT_BITS_MAX - 1u - (msb - lsb));
+
+    /* Format from a copy, the name and the prefix are members of the same struct. */
+    memcpy(name, field->name, sizeof(name));
+    if (count == 2u) {
+        len = snprintf(field->prefix, sizeof(field->prefix), "  %s[%u:%u] = ", name,
+                       (unsigned)msb, (unsigned)lsb);
+    } else {
+        len = snprintf(field->prefix, sizeof(field->prefix), "  %s[%u] = ", name, (unsigned)msb);
+    }
+    field->prefixLen = (uint32_t)len;
+
+    return 0;
+}
+
+/*!
+ * \brief Compile the "<value>=<label>,..." token of a field into its label slots.
+ * \details
+ *      Every value from 0 up to the highest labelled value gets a slot, so that decoding is a
+ *      single indexed lookup.
+ * \param token
+ *      The labels token.
+ * \param[out] field
+ *      The field, its label slots are set.
+ * \param[out] layout
+ *      The layout that holds the label slots.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int CompileLabels(const Token *token, LayoutField *field, Layout *layout)
+{
+    Token labels[LAYOUT_LINE_SIZE_MAX / 2u];
+    Token parts[2];
+    uint64_t value = 0;
+    uint64_t valueMax = 0;
+    size_t labelCount = 0;
+    size_t pass = 0;
+    size_t i = 0;
+    uint32_t slot = 0;
+
+    labelCount = SplitLine(token->string, token->len, ',', labels,
+                           sizeof(labels) / sizeof(labels[0]));
+    if (labelCount > (sizeof(labels) / sizeof(labels[0]))) {
+        return -1;
+    }
+
+    /* The first pass checks the labels and finds the highest value, the second one stores them. */
+    for (pass = 0; pass < 2u; pass++) {
+        for (i = 0; i < labelCount; i++) {
+            if ((SplitLine(labels[i].string, labels[i].len, '=', parts, 2) != 2u) ||
+                (ConvertToken(&parts[0], &value) != 0) || (value > field->mask) ||
+                (parts[1].len == 0) || (parts[1].len >= LAYOUT_LABEL_SIZE)) {
+                return -1;
+            }
+
+            if (pass == 0) {
+                valueMax = (value > valueMax) ? value : valueMax;
+                continue;
+            }
+
+            slot = field->labelOffset + (uint32_t)value;
+            if (layout->labelLens[slot] != 0) {
+                /* Duplicate value. */
+                return -1;
+            }
+            memcpy(layout->labels[slot], parts[1].string, parts[1].len);
+            layout->labels[slot][parts[1].len] = '\0';
+            layout->labelLens[slot] = (uint8_t)parts[1].len;
+        }
+
+        if (pass == 0) {
+            if (valueMax >= (uint64_t)(LAYOUT_LABELS_MAX - layout->labelCount)) {
+                return -1;
+            }
+            field->labelOffset = layout->labelCount;
+            field->labelCount = (uint32_t)valueMax + 1u;
+            layout->labelCount += field->labelCount;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * \brief Compile a single line of a layout description.
+ * \param line
+ *      The line, without the line ending.
+ * \param len
+ *      The length of the line.
+ * \param[out] layout
+ *      The layout, a field is added for every non-empty line.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int CompileLine(const char *line, size_t len, Layout *layout)
+{
+    Token tokens[LAYOUT_TOKENS_MAX];
+    LayoutField *field = NULL;
+    size_t count = 0;
+    size_t i = 0;
+
+    count = SplitLine(line, len, '\0', tokens, LAYOUT_TOKENS_MAX);
+    if ((count == 0) || (tokens[0].string[0] == '#')) {
+        return 0;
+    }
+
+    if ((count < 2u) || (count > LAYOUT_TOKENS_MAX) ||
+        (layout->fieldCount == LAYOUT_FIELDS_MAX) || (tokens[0].len >= LAYOUT_NAME_SIZE)) {
+        return -1;
+    }
+
+    for (i = 0; i < tokens[0].len; i++) {
+        if (IsNameChar(tokens[0].string[i], (i == 0)) == false) {
+            return -1;
+        }
+    }
+
+    field = &layout->fields[layout->fieldCount];
+    memset(field, 0, sizeof(*field));
+    memcpy(field->name, tokens[0].string, tokens[0].len);
+    field->nameLen = (uint32_t)tokens[0].len;
+
+    if ((CompileBits(&tokens[1], field) != 0) ||
+        ((count == 3u) && (CompileLabels(&tokens[2], field, layout) != 0))) {
+        return -1;
+    }
+
+    layout->fieldCount++;
+
+    return 0;
+}
+
+/*!
+ * \brief Compile a layout description.
+ * \param text
+ *      The layout description, see the file description.
+ * \param len
+ *      The length of text.
+ * \param[out] layout
+ *      The compiled layout.
+ * \returns
+ *      0 in case of successful completion or the number of the first invalid line.
+ */
+int CompileLayout(const char *text, size_t len, Layout *layout)
+{
+    size_t start = 0;
+    size_t end = 0;
+    size_t lineLen = 0;
+    int lineNumber = 0;
+
+    layout->fieldCount = 0;
+    layout->labelCount = 0;
+    memset(layout->labelLens, 0, sizeof(layout->labelLens));
+
+    for (start = 0; start < len; start = end + 1u) {
+        lineNumber++;
+
+        end = start;
+        while ((end < len) && (text[end] != '\n')) {
+            end++;
+        }
+
+        lineLen = end - start;
+        if ((lineLen > 0) && (text[end - 1u] == '\r')) {
+            lineLen--;
+        }
+
+        if ((lineLen >= LAYOUT_LINE_SIZE_MAX) || (CompileLine(&text[start], lineLen, layout) != 0)) {
+            return lineNumber;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * \brief Load and compile a layout file.
+ * \param path
+ *      The layout file.
+ * \param[out] layout
+ *      The compiled layout.
+ * \returns
+ *      0 in case of successful completion, -1 if the file can not be read or the number of the
+ *      first invalid line.
+ */
+int LoadLayout(const char *path, Layout *layout)
+{
+    FILE *fp = NULL;
+    char *text = NULL;
+    size_t len = 0;
+    int retval = -1;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    text = malloc(LAYOUT_FILE_SIZE_MAX);
+    if (text != NULL) {
+        len = fread(text, 1, LAYOUT_FILE_SIZE_MAX, fp);
+        if ((ferror(fp) == 0) && (len < LAYOUT_FILE_SIZE_MAX)) {
+            retval = CompileLayout(text, len, layout);
+        }
+        free(text);
+    }
+
+    fclose(fp);
+
+    return retval;
+}
+
+/*!
+ * \brief Format the fields of a number as it is printed to the console, one line per field.
+ * \param layout
+ *      The compiled layout.
+ * \param number
+ *      The number to decode.
+ * \param[out] buf
+ *      The output buffer, at least LAYOUT_FIELDS_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatFields(const Layout *layout, uint64_t number, char *buf)
+{
+    const LayoutField *field = NULL;
+    uint64_t value = 0;
+    uint32_t slot = 0;
+    size_t len = 0;
+    uint32_t i = 0;
+
+    memcpy(&buf[len], "Fields:\n", 8);
+    len += 8;
+
+    for (i = 0; i < layout->fieldCount; i++) {
+        field = &layout->fields[i];
+        value = LayoutFieldValue(field, number);
+
+        memcpy(&buf[len], field->prefix, field->prefixLen);
+        len += field->prefixLen;
+        len += FormatDecimal(value, &buf[len]);
+
+        if (value < field->labelCount) {
+            slot = field->labelOffset + (uint32_t)value;
+            if (layout->labelLens[slot] != 0) {
+                buf[len++] = ' ';
+                buf[len++] = '(';
+                memcpy(&buf[len], layout->labels[slot], layout->labelLens[slot]);
+                len += layout->labelLens[slot];
+                buf[len++] = ')';
+            }
+        }
+        buf[len++] = '\n';
+    }
+
+    memcpy(&buf[len], "\n", 2);
+    len += 1;
+
+    return len;
+}
+
+/*!
+ * \brief Format the fields of a number on a single line, f.e. " ENABLE=on MODE=2\n".
+ * \details
+ *      A field value that has a label is replaced by it.
+ * \param layout
+ *      The compiled layout.
+ * \param number
+ *      The number to decode.
+ * \param[out] buf
+ *      The output buffer, at least LAYOUT_LINE_FORMAT_SIZE - LAYOUT_TOKEN_SIZE bytes.
+ * \returns
+ *      The length of the formatted line. Not terminated.
+ */
+size_t FormatFieldsLine(const Layout *layout, uint64_t number, char *buf)
+{
+    const LayoutField *field = NULL;
+    uint64_t value = 0;
+    uint32_t slot = 0;
+    size_t len = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < layout->fieldCount; i++) {
+        field = &layout->fields[i];
+        value = LayoutFieldValue(field, number);
+
+        buf[len++] = ' ';
+        memcpy(&buf[len], field->name, field->nameLen);
+        len += field->nameLen;
+        buf[len++] = '=';
+
+        slot = field->labelOffset + (uint32_t)value;
+        if ((value < field->labelCount) && (layout->labelLens[slot] != 0)) {
+            memcpy(&buf[len], layout->labels[slot], layout->labelLens[slot]);
+            len += layout->labelLens[slot];
+        } else {
+            len += FormatDecimal(value, &buf[len]);
+        }
+    }
+    buf[len++] = '\n';
+
+    return len;
+}
+
+/*!
+ * \brief Decode a single batch value into an output line.
+ * \param layout
+ *      The compiled layout.
+ * \param separators
+ *      The separator characters or NULL for none.
+ * \param token
+ *      The value as given.
+ * \param len
+ *      The length of token.
+ * \param isTooLong
+ *      true if the value was truncated to token.
+ * \param[out] buf
+ *      The output buffer, at least LAYOUT_LINE_FORMAT_SIZE bytes.
+ * \param[out] retval
+ *      Set to -1 in case of an invalid value, otherwise left unchanged.
+ * \returns
+ *      The length of the output line.
+ */
+static size_t DecodeToken(const Layout *layout, const char *separators, const char *token,
+                          size_t len, bool isTooLong, char *buf, int *retval)
+{
+    uint64_t number = 0;
+
+    memcpy(buf, token, len);
+
+    if ((isTooLong == true) || (ConvertSeparatedString(token, len, separators, &number) != 0)) {
+        memcpy(&buf[len], " invalid\n", 9);
+        *retval = -1;
+        return len + 9u;
+    }
+
+    return len + FormatFieldsLine(layout, number, &buf[len]);
+}
+
+/*!
+ * \brief Decode whitespace separated values from a stream, one output line per value.
+ * \details
+ *      Every line holds the value as given followed by FormatFieldsLine(), or "invalid". When a
+ *      space or tab is one of the separators, f.e. for "1010 1100b", the values are separated by
+ *      line ends only and the blanks around them are ignored.
+ * \param layout
+ *      The compiled layout.
+ * \param separators
+ *      The separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param in
+ *      The input stream.
+ * \param out
+ *      The output stream.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an invalid value or an
+ *      error.
+ */
+int DecodeStream(const Layout *layout, const char *separators, FILE *in, FILE *out)
+{
+    char token[LAYOUT_TOKEN_SIZE];
+    char *input = NULL;
+    char *output = NULL;
+    size_t tokenLen = 0;
+    size_t outputLen = 0;
+    size_t len = 0;
+    size_t i = 0;
+    bool isTooLong = false;
+    bool isEnd = false;
+    bool isLineSplit = false;
+    bool isDelimiter = false;
+    char c = '\0';
+    int retval = 0;
+    int status = 0;
+
+    if ((separators != NULL) &&
+        ((strchr(separators, ' ') != NULL) || (strchr(separators, '\t') != NULL))) {
+        /* Blanks are part of the values, only line ends separate them. */
+        isLineSplit = true;
+    }
+
+    input = malloc(LAYOUT_CHUNK_SIZE);
+    output = malloc(LAYOUT_CHUNK_SIZE + LAYOUT_LINE_FORMAT_SIZE);
+    if ((input == NULL) || (output == NULL)) {
+        free(input);
+        free(output);
+        return -1;
+    }
+
+    while ((isEnd == false) && (status == 0)) {
+        len = fread(input, 1, LAYOUT_CHUNK_SIZE, in);
+        if (len == 0) {
+            /* Terminate the last value. */
+            isEnd = true;
+            input[len++] = '\n';
+        }
+
+        for (i = 0; i < len; i++) {
+            c = input[i];
+            isDelimiter = ((c == '\r') || (c == '\n') ||
+                           ((isLineSplit == false) && (IsBlank(c) == true)));
+            if (isDelimiter == false) {
+                if ((tokenLen == 0) && (IsBlank(c) == true)) {
+                    /* Leading blanks of a line. */
+                    continue;
+                }
+                if (tokenLen < sizeof(token)) {
+                    token[tokenLen++] = c;
+                } else {
+                    isTooLong = true;
+                }
+                continue;
+            }
+
+            if (tokenLen == 0) {
+                continue;
+            }
+
+            /* Trailing blanks of a line. */
+            while (IsBlank(token[tokenLen - 1u]) == true) {
+                tokenLen--;
+            }
+
+            outputLen += DecodeToken(layout, separators, token, tokenLen, isTooLong,
+                                     &output[outputLen], &retval);
+            tokenLen = 0;
+            isTooLong = false;
+
+            if (outputLen >= LAYOUT_CHUNK_SIZE) {
+                if (fwrite(output, 1, outputLen, out) != outputLen) {
+                    status = -1;
+                    break;
+                }
+                outputLen = 0;
+            }
+        }
+    }
+
+    if ((status == 0) && ((ferror(in) != 0) || (fwrite(output, 1, outputLen, out) != outputLen))) {
+        status = -1;
+    }
+
+    free(input);
+    free(output);
+
+    return (status != 0) ? status : retval;
+}
@@ -0,0 +1,166 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*!
+ * \file
+ * \brief Register-layout decoding of numbers into named bit fields.
+ * \details
+ *      A layout file describes one field per line, blank lines and lines starting with '#' are
+ *      ignored:
+ *
+ *          <name> <msb>:<lsb> [<value>=<label>,...]
+ *          <name> <bit> [<value>=<label>,...]
+ *
+ *      F.e. "MODE 3:1 0=idle,1=run,2=sleep". The layout is compiled once into a flat table of
+ *      shift, mask and label lookup operations per field, decoding a number touches nothing else.
+ */
+
+#ifndef LAYOUT_H__
+#define LAYOUT_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define LAYOUT_FIELDS_MAX           64u
+#define LAYOUT_NAME_SIZE            32u   /* 31 characters + string terminator. */
+#define LAYOUT_PREFIX_SIZE          48u   /* "  <name>[<msb>:<lsb>] = " */
+#define LAYOUT_LABELS_MAX           4096u /* The label slots of all fields together. */
+#define LAYOUT_LABEL_SIZE           32u   /* 31 characters + string terminator. */
+#define LAYOUT_LINE_SIZE_MAX        1024u /* The longest line in a layout file. */
+#define LAYOUT_TOKEN_SIZE           256u  /* The longest value in batch mode. */
+
+/* "Fields:\n", per field "<prefix><20 digits> (<label>)\n" and "\n". */
+#define LAYOUT_FIELDS_FORMAT_SIZE   (8u + (LAYOUT_FIELDS_MAX * (LAYOUT_PREFIX_SIZE + 20u + 3u + \
+                                     LAYOUT_LABEL_SIZE)) + 2u)
+/* "<value>", per field " <name>=<20 digits or label>" and "\n". */
+#define LAYOUT_LINE_FORMAT_SIZE     (LAYOUT_TOKEN_SIZE + (LAYOUT_FIELDS_MAX * (2u + \
+                                     LAYOUT_NAME_SIZE + LAYOUT_LABEL_SIZE)) + 2u)
+
+/*!
+ * \brief A compiled field.
+ */
+typedef struct {
+    uint64_t mask;                      /*!< The field mask, applied after shifting. */
+    uint32_t shift;                     /*!< The bit number of the least significant bit. */
+    uint32_t labelOffset;               /*!< The label slot of value 0. */
+    uint32_t labelCount;                /*!< Values below labelCount have a label slot. */
+    uint32_t nameLen;                   /*!< The length of name. */
+    uint32_t prefixLen;                 /*!< The length of prefix. */
+    char name[LAYOUT_NAME_SIZE];        /*!< The field name. */
+    char prefix[LAYOUT_PREFIX_SIZE];    /*!< The field line prefix, f.e. "  MODE[3:1] = ". */
+} LayoutField;
+
+/*!
+ * \brief A compiled layout.
+ */
+typedef struct {
+    LayoutField fields[LAYOUT_FIELDS_MAX];              /*!< The fields in file order. */
+    uint32_t fieldCount;                                /*!< The number of fields. */
+    uint32_t labelCount;                                /*!< The number of used label slots. */
+    uint8_t labelLens[LAYOUT_LABELS_MAX];               /*!< The label lengths, 0 for none. */
+    char labels[LAYOUT_LABELS_MAX][LAYOUT_LABEL_SIZE];  /*!< The labels. */
+} Layout;
+
+/*!
+ * \brief Extract the value of a field from a number.
+ * \param field
+ *      The compiled field.
+ * \param number
+ *      The number to decode.
+ * \returns
+ *      The field value.
+ */
+static inline uint64_t LayoutFieldValue(const LayoutField *field, uint64_t number)
+{
+    return (number >> field->shift) & field->mask;
+}
+
+/*!
+ * \brief Compile a layout description.
+ * \param text
+ *      The layout description, see the file description.
+ * \param len
+ *      The length of text.
+ * \param[out] layout
+ *      The compiled layout.
+ * \returns
+ *      0 in case of successful completion or the number of the first invalid line.
+ */
+int CompileLayout(const char *text, size_t len, Layout *layout);
+
+/*!
+ * \brief Load and compile a layout file.
+ * \param path
+ *      The layout file.
+ * \param[out] layout
+ *      The compiled layout.
+ * \returns
+ *      0 in case of successful completion, -1 if the file can not be read or the number of the
+ *      first invalid line.
+ */
+int LoadLayout(const char *path, Layout *layout);
+
+/*!
+ * \brief Format the fields of a number as it is printed to the console, one line per field.
+ * \param layout
+ *      The compiled layout.
+ * \param number
+ *      The number to decode.
+ * \param[out] buf
+ *      The output buffer, at least LAYOUT_FIELDS_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatFields(const Layout *layout, uint64_t number, char *buf);
+
+/*!
+ * \brief Format the fields of a number on a single line, f.e. " ENABLE=on MODE=2\n".
+ * \details
+ *      A field value that has a label is replaced by it.
+ * \param layout
+ *      The compiled layout.
+ * \param number
+ *      The number to decode.
+ * \param[out] buf
+ *      The output buffer, at least LAYOUT_LINE_FORMAT_SIZE - LAYOUT_TOKEN_SIZE bytes.
+ * \returns
+ *      The length of the formatted line. Not terminated.
+ */
+size_t FormatFieldsLine(const Layout *layout, uint64_t number, char *buf);
+
+/*!
+ * \brief Decode whitespace separated values from a stream, one output line per value.
+ * \details
+ *      Every line holds the value as given followed by FormatFieldsLine(), or "invalid". When a
+ *      space or tab is one of the separators, f.e. for "1010 1100b", the values are separated by
+ *      line ends only and the blanks around them are ignored.
+ * \param layout
+ *      The compiled layout.
+ * \param separators
+ *      The separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param in
+ *      The input stream.
+ * \param out
+ *      The output stream.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an invalid value or an
+ *      error.
+ */
+int DecodeStream(const Layout *layout, const char *separators, FILE *in, FILE *out);
+
+#endif /* LAYOUT_H__ */
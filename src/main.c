@@ -19,493 +19,127 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
-#include "version.h"
-
-#define BINARY_STRING_LEN_MAX           65u
-#define DECIMAL_STRING_LEN_MAX          20u
-#define HEXADECIMAL_H_STRING_LEN_MAX    17u
-#define HEXADECIMAL_0X_STRING_LEN_MAX   18u
-#define BUFFER_SIZE                     (BINARY_STRING_LEN_MAX + 1u) /* + string terminator. */
-
-/* UINT64_MAX equivalent string. */
-const char *DecimalStringValueMax = "18446744073709551615";
-
-static bool IsBinaryChar(char c);
-static bool IsDecimalChar(char c);
-static bool IsHexadecimalChar(char c);
-static void PrintBinary(uint64_t number);
-static void PrintDecimal(uint64_t number);
-static void PrintHexadecimal(uint64_t number);
-static void ParseBinary(const char *string, size_t len, uint64_t *number);
-static void ParseDecimal(const char *string, size_t len, uint64_t *number);
-static void ParseHexadecimal(const char *string, size_t len, uint64_t *number);
-static bool IsBinary(const char *string, size_t len);
-static bool IsDecimal(const char *string, size_t len);
-static bool IsHexadecimal(const char *string, size_t len);
-static void PrintNumerals(uint64_t number);
-static void ParseString(const char *string, size_t len, uint64_t *number, char base);
-static int CheckString(const char *string, size_t len, char *base);
+#if defined(NUMCONVERT_RAW_WRITE)
+#include <errno.h>
+#include <unistd.h>
+#endif
+#include "numconvert.h"
+#include "shmring.h"
+#include "range.h"
+#include "stream.h"
+#include "layout.h"
+
+static int WriteOutput(const char *buf, size_t len);
+static int FlushOutput(int retval);
 static void PrintHelp(void);
+static int PrintFields(const Layout *layout, const char *argument, const char *separators);
 
 /*!
- * \brief Convert a character to it's lowercase equivalent (when required).
- * \param c
- *      The character to convert.
- * \returns
- *      The lowercase equivalent of c or c when no conversion was required.
- */
-static char ToLower(char c)
-{
-    if ((c >= 'A') && (c <= 'Z')) {
-        c = (char)(c + 0x20);
-    }
-
-    return c;
-}
-
-/*!
- * \brief Indicate if a character represents a valid Binary character.
- * \param c
- *      The character to verify.
- * \returns
- *      true if the character represents a valid Binary character, otherwise false.
- */
-static bool IsBinaryChar(char c)
-{
-    bool isBinaryChar = false;
-
-    if ((c == '0') || (c == '1')) {
-        isBinaryChar = true;
-    }
-
-    return isBinaryChar;
-}
-
-/*!
- * \brief Indicate if a character represents a valid Decimal character.
- * \param c
- *      The character to verify.
- * \returns
- *      true if the character represents a valid Decimal character, otherwise false.
- */
-static bool IsDecimalChar(char c)
-{
-    bool isDecimalChar = false;
-
-    if ((c >= '0') && (c <= '9')) {
-        isDecimalChar = true;
-    }
-
-    return isDecimalChar;
-}
-
-/*!
- * \brief Indicate if a character represents a valid Hexadecimal character.
- * \param c
- *      The character to verify.
- * \returns
- *      true if the character represents a valid Hexadecimal character, otherwise false.
- */
-static bool IsHexadecimalChar(char c)
-{
-    bool isHexaDecimalChar = false;
-
-    if ((IsDecimalChar(c) == true) ||
-        ((c >= 'a') && (c <= 'f'))) {
-        isHexaDecimalChar = true;
-    }
-
-    return isHexaDecimalChar;
-}
-
-/*!
- * \brief Print a number in Binary format to the console.
- * \param number
- *      The number to print.
- */
-static void PrintBinary(uint64_t number)
-{
-    int64_t i = 0;
-
-    printf("Binary:\n  ");
-
-    for (i = 63; i >= 0; i--) {
-        if (((number >> i) & 0x1) == 0x1) {
-            putchar('1');
-        } else {
-            putchar('0');
-        }
-
-        if (i % 4 == 0) {
-            putchar(' ');
-
-            if (i == 32) {
-                putchar('\n');
-                putchar(' ');
-                putchar(' ');
-            }
-        }
-    }
-
-    putchar('\n');
-}
-
-/*!
- * \brief Print a number in Decimal format to the console.
- * \param number
- *      The number to print.
- */
-static void PrintDecimal(uint64_t number)
-{
-    printf("Decimal:\n");
-    printf("  %llu\n", (unsigned long long)number);
-}
-
-/*!
- * \brief Print a number in Hexadecimal format to the console.
- * \param number
- *      The number to print.
- */
-static void PrintHexadecimal(uint64_t number)
-{
-    printf("Hexadecimal:\n");
-    printf("  0x%llx\n", (long long unsigned int)number);
-}
-
-/*!
- * \brief Parse a string that represents a Binary value and returns its value.
- * \param string
- *      The string to parse.
- * \param len
- *      The length of the input string (excluding the string terminator).
- * \param[out] number
- *      The number represented by the numeric string.
- */
-static void ParseBinary(const char *string, size_t len, uint64_t *number)
-{
-    int64_t i = 0;
-
-    *number = 0;
-
-    for (i = ((int64_t)len - 1); i >= 0; i--) {
-        if (string[i] == '1') {
-            *number += (uint64_t)1 << (len - 2 - i);
-        }
-    }
-}
-
-/*!
- * \brief Parse a string that represents a Decimal value and returns its value.
- * \param string
- *      The string to parse.
- * \param len
- *      The length of the input string (excluding the string terminator).
- * \param[out] number
- *      The number represented by the numeric string.
- */
-static void ParseDecimal(const char *string, size_t len, uint64_t *number)
-{
-    uint64_t val = 0;
-    int64_t i = 0;
-    uint64_t value = 0;
-
-    *number = 0;
-
-    val = 1;
-    for (i = ((int64_t)len - 1); i >= 0; i--) {
-        value = (string[i] - 0x30) * val;
-        *number += value;
-        val *= 10;
-    }
-}
-
-/*!
- * \brief Parse a string that represents a Hexadecimal value and returns its value.
- * \param string
- *      The string to parse.
- * \param len
- *      The length of the input string (excluding the string terminator).
- * \param[out] number
- *      The number represented by the numeric string.
- */
-static void ParseHexadecimal(const char *string, size_t len, uint64_t *number)
-{
-    int64_t i = 0;
-    uint64_t value = 0;
-    uint64_t start = 0;
-    int64_t end = 0;
-
-    *number = 0;
-
-    if (string[len - 1] == 'h') {
-        start = len - 2;
-        end = 0;
-    } else { /* starts with 0x */
-        start = len - 1;
-        end = 2;
-    }
-
-    for (i = (int64_t)start; i >= end; i--) {
-        switch (string[i]) {
-            case 'a':
-            case 'b':
-            case 'c':
-            case 'd':
-            case 'e':
-                /* No break. */
-            case 'f':
-                value = (uint64_t)string[i] - 0x61 + 10;
-                break;
-            default:
-                value = (uint64_t)string[i] - 0x30;
-                break;
-        }
-        *number |= value << ((start - i) * 4);
-    }
-}
-
-/*!
- * \brief Indicate if a string represents a valid Binary value.
- * \param string
- *      The string to verify.
+ * \brief Write console output to stdout.
+ * \details
+ *      The startup optimized build (NUMCONVERT_RAW_WRITE) writes with write(2) directly, so that a
+ *      one-shot conversion never initializes or flushes stdio. Otherwise stdout is flushed, so
+ *      that write errors are not lost at exit.
+ * \param buf
+ *      The output.
  * \param len
- *      The length of the input string (excluding the string terminator).
+ *      The length of the output.
  * \returns
- *      true if the string represents a valid Binary value, otherwise false.
+ *      0 in case of successful completion or any other value in case of an error.
  */
-static bool IsBinary(const char *string, size_t len)
+static int WriteOutput(const char *buf, size_t len)
 {
-    bool isBinary = false;
-    uint64_t i = 0;
-
-    if (string[len - 1] == 'b') {
-        isBinary = true;
-        for (i = 0; i < (len - 1); i++) {
-            if (IsBinaryChar(string[i]) == false) {
-                isBinary = false;
-                break;
-            }
-        }
-    }
-
-    if (isBinary == true) {
-        /* No need to check for maximum length:
-         * - (len >= BINARY_STRING_LEN_MAX + 1), or BUFFER_SIZE, is covered by main()
-         */
-        if (len < 2) {
-            /* This isn't gonna fit in UINT64_MAX. */
-            isBinary = false;
+#if defined(NUMCONVERT_RAW_WRITE)
+    ssize_t written = 0;
+
+    /* Continue after partial writes and interrupts. */
+    while (len > 0) {
+        written = write(STDOUT_FILENO, buf, len);
+        if ((written < 0) && (errno == EINTR)) {
+            continue;
         }
-    }
-
-    return isBinary;
-}
-
-/*!
- * \brief Indicate if a string represents a valid Decimal value.
- * \param string
- *      The string to verify.
- * \param len
- *      The length of the input string (excluding the string terminator).
- * \returns
- *      true if the string represents a valid Decimal value, otherwise false.
- */
-static bool IsDecimal(const char *string, size_t len)
-{
-    bool isDecimal = true;
-    uint64_t i = 0;
-
-    for (i = 0; i < len; i++) {
-        if (IsDecimalChar(string[i]) == false) {
-            isDecimal = false;
-            break;
+        if (written <= 0) {
+            return -1;
         }
+        buf += written;
+        len -= (size_t)written;
     }
 
-    if (isDecimal == true) {
-        /* No need to check for minimum length:
-         * - (len == 0) is covered by CheckString()
-         */
-        if (len == DECIMAL_STRING_LEN_MAX) {
-            for (i = 0; i < DECIMAL_STRING_LEN_MAX; i++) {
-                if ((string[i] - 0x30) > (DecimalStringValueMax[i] - 0x30)) {
-                    /* This isn't gonna fit in UINT64_MAX. */
-                    isDecimal = false;
-                    break;
-                } else if ((string[i] - 0x30) == (DecimalStringValueMax[i] - 0x30)) {
-                    /* Continue checking the lower digits, it can still become too large. */
-                    continue;
-                } else {
-                    /* No need to continue checking the lower digits, it cannot become too large. */
-                    break;
-                }
-            }
-        } else if (len > DECIMAL_STRING_LEN_MAX) {
-            isDecimal = false;
-        }
-        /* else: will not happen because it's protected by CheckString(). */
+    return 0;
+#else
+    if ((fwrite(buf, 1, len, stdout) != len) || (fflush(stdout) != 0)) {
+        return -1;
     }
 
-    return isDecimal;
+    return 0;
+#endif
 }
 
 /*!
- * \brief Indicate if a string represents a valid Hexadecimal value.
- * \param string
- *      The string to verify.
- * \param len
- *      The length of the input string (excluding the string terminator).
+ * \brief Flush stdout after a mode that writes through stdio.
+ * \param retval
+ *      The result of the mode.
  * \returns
- *      true if the string represents a valid Hexadecimal value, otherwise false.
+ *      retval, or -1 in case the output could not be written.
  */
-static bool IsHexadecimal(const char *string, size_t len)
+static int FlushOutput(int retval)
 {
-    bool isHexaDecimal = true;
-    uint64_t i = 0;
-    uint64_t start = 0;
-    uint64_t end = 0;
-    uint64_t minLen = 0;
-    uint64_t maxLen = 0;
-
-    if (string[len - 1] == 'h') {
-        start = 0;
-        end = len - 1;
-        minLen = 2;
-        maxLen = HEXADECIMAL_H_STRING_LEN_MAX;
-    } else if ((string[0] == '0') && (string[1] == 'x')) {
-        start = 2;
-        end = len;
-        minLen = 3;
-        maxLen = HEXADECIMAL_0X_STRING_LEN_MAX;
-    } else {
-        isHexaDecimal = false;
-    }
-
-    if (isHexaDecimal == true) {
-        for (i = start; i < end; i++) {
-            if (IsHexadecimalChar(string[i]) == false) {
-                isHexaDecimal = false;
-                break;
-            }
-        }
+    if ((fflush(stdout) != 0) && (retval == 0)) {
+        retval = -1;
     }
 
-    if (isHexaDecimal == true) {
-        if ((len < minLen) ||
-            (len > maxLen)) {
-            /* This isn't gonna fit in UINT64_MAX. */
-            isHexaDecimal = false;
-        }
-    }
-
-    return isHexaDecimal;
+    return retval;
 }
 
 /*!
- * \brief Print a number to the console in Binary, Decimal and Hexadecimal.
- * \param number
- *      The number to print.
+ * \brief Print the help menu to the console.
  */
-static void PrintNumerals(uint64_t number)
+static void PrintHelp(void)
 {
-    putchar('\n');
-
-    /* Decimal. */
-    PrintDecimal(number);
-
-    /* Binary. */
-    PrintBinary(number);
+    char output[OUTPUT_BUFFER_SIZE];
+    size_t len = 0;
 
-    /* Hexadecimal. */
-    PrintHexadecimal(number);
+    len = FormatHelp(output);
 
-    putchar('\n');
+    /* The help menu is printed on errors, the exit code is non-zero already. */
+    (void)WriteOutput(output, len);
 }
 
 /*!
- * \brief Parse an input string and return it's represented value as a number.
- * \param string
- *      The input string to parse.
- * \param len
- *      The length of the input string (excluding the string terminator).
- * \param[out] number
- *      The number represented by the numeric string in case it checked-out.
- * \param base
- *      The base of the numeric string.
- */
-static void ParseString(const char *string, size_t len, uint64_t *number, const char base)
-{
-    if (base == 'd') {
-        ParseDecimal(string, len, number);
-    } else if (base == 'h') {
-        ParseHexadecimal(string, len, number);
-    } else {
-        /* base == 'b' is the only one left.
-         * Nothing else will happen because it's protected by CheckString().
-         */
-        ParseBinary(string, len, number);
-    }
-}
-
-/*!
- * \brief Check an input string to be an expected numeric string.
- * \param string
- *      The input string to check.
- * \param len
- *      The length of the input string (excluding the string terminator).
- * \param[out] base
- *      The base of the numeric string in case it checked-out.
+ * \brief Print the numerals and the register fields of a command line argument to the console.
+ * \param layout
+ *      The compiled layout.
+ * \param argument
+ *      The command line argument, f.e. "0x12" or "1010B".
+ * \param separators
+ *      The separator characters or NULL for none.
  * \returns
  *      0 in case of successful completion or any other value in case of an error.
  */
-static int CheckString(const char *string, size_t len, char *base)
+static int PrintFields(const Layout *layout, const char *argument, const char *separators)
 {
-    /* Is the len okay? */
-    if (len == 0) {
-        return -1;
-    }
+    static char fields[LAYOUT_FIELDS_FORMAT_SIZE];
+    char output[OUTPUT_BUFFER_SIZE];
+    uint64_t number = 0;
+    size_t len = 0;
+    int retval = 0;
 
-    /* Is Binary? */
-    if (IsBinary(string, len) == true) {
-        *base = 'b';
-        return 0;
+    retval = ConvertSeparatedString(argument, strlen(argument), separators, &number);
+    if (retval != 0) {
+        PrintHelp();
+        return retval;
     }
 
-    /* Is Decimal? */
-    if (IsDecimal(string, len) == true) {
-        *base = 'd';
-        return 0;
-    }
+    /* FormatNumerals() ends with an empty line, the fields take its place. */
+    len = FormatNumerals(number, output);
+    retval = WriteOutput(output, len - 1u);
 
-    /* Is Hexadecimal? */
-    if (IsHexadecimal(string, len) == true) {
-        *base = 'h';
-        return 0;
+    if (retval == 0) {
+        len = FormatFields(layout, number, fields);
+        retval = WriteOutput(fields, len);
     }
 
-    /* Is none of the above. */
-    return -1;
-}
-
-/*!
- * \brief Print the help menu to the console.
- */
-static void PrintHelp(void)
-{
-    printf("Version %s\n\n", GetVersionString());
-
-    printf("Usage:\n");
-    printf("  numconvert [prefix]<value>[postfix]\n");
-
-    printf("\nNo prefix/postfix:\n");
-    printf("            to indicate a decimal value\n");
-
-    printf("\nPrefixes:\n");
-    printf("  0x or 0X, to indicate a hexadecimal value\n");
-
-    printf("\nPostfixes:\n");
-    printf("  b or B,   to indicate a binary value\n");
-    printf("  h or H,   to indicate a hexadecimal value\n\n");
+    return retval;
 }
 
 /*!
@@ -516,6 +150,21 @@ static void PrintHelp(void)
  *          Hexadecimal value, f.e.: 12345h or 0x12345
  *          Binary value, f.e.: 011010110b
  *      Only values between 0 - 2^64 are allowed.
+ *
+ *      The value may be preceded by "--separators <chars>" to ignore digit separators in it, f.e.
+ *      --separators "_'," 0xdead_beef.
+ *
+ *      "--range <start>:<end>[:<step>]" replaces the value and prints every value in [start, end),
+ *      formatted by "--threads <n>" threads.
+ *
+ *      "--layout <file>" decodes the value into the register fields described in <file>, see
+ *      layout.h. A value of "-" decodes every value read from stdin instead.
+ *
+ *      "--stream <bin2hex|hex2bin>" replaces the value and converts a digit stream of any length
+ *      from stdin to stdout, see stream.h.
+ *
+ *      Alternatively "--shm <name>" serves conversion requests from co-located processes through
+ *      a shared-memory ring, see shmring.h.
  * \param argc
  *      The number of string pointed to by argv (argument count).
  * \param argv
@@ -525,43 +174,109 @@ static void PrintHelp(void)
  */
 int main(int argc, char *argv[])
 {
-    char base = '\0';
-    char string[BUFFER_SIZE];
+    static Layout layout;
+    char output[OUTPUT_BUFFER_SIZE];
+    const char *separators = NULL;
+    const char *rangeArgument = NULL;
+    const char *layoutPath = NULL;
+    char streamBase = '\0';
+    Range range;
+    uint64_t threadCount = 1;
+    bool isThreadCountSet = false;
     int retval = 0;
-    uint64_t number = 0;
-    uint64_t i = 0;
+    int argi = 1;
     size_t len = 0;
 
-    /* Check argument. */
-    if (argc != 2) {
-        /* Missing or too many arguments. */
-        PrintHelp();
-        return -1;
+    /* Check for the shared-memory ring mode. */
+    if ((argc == 3) && (strcmp(argv[1], "--shm") == 0)) {
+        return ShmRingServe(argv[2]);
     }
 
-    /* Determine string length. */
-    len = strlen(argv[1]);
-    if (len >= sizeof(string)) {
+    /* Check options, each one takes a value. */
+    while (((argi + 1) < argc) && (strncmp(argv[argi], "--", 2) == 0)) {
+        if ((strcmp(argv[argi], "--separators") == 0) && (CheckSeparators(argv[argi + 1]) == 0)) {
+            separators = argv[argi + 1];
+        } else if ((strcmp(argv[argi], "--threads") == 0) &&
+                   (ConvertString(argv[argi + 1], strlen(argv[argi + 1]), &threadCount) == 0) &&
+                   (threadCount >= 1u) && (threadCount <= RANGE_THREADS_MAX)) {
+            isThreadCountSet = true;
+        } else if (strcmp(argv[argi], "--range") == 0) {
+            rangeArgument = argv[argi + 1];
+        } else if ((strcmp(argv[argi], "--stream") == 0) &&
+                   (strcmp(argv[argi + 1], "bin2hex") == 0)) {
+            streamBase = 'b';
+        } else if ((strcmp(argv[argi], "--stream") == 0) &&
+                   (strcmp(argv[argi + 1], "hex2bin") == 0)) {
+            streamBase = 'h';
+        } else if (strcmp(argv[argi], "--layout") == 0) {
+            layoutPath = argv[argi + 1];
+        } else {
+            /* Unknown option or invalid option value. */
+            PrintHelp();
+            return -1;
+        }
+        argi += 2;
+    }
+
+    /* The thread count only applies to the range mode. */
+    if ((isThreadCountSet == true) && (rangeArgument == NULL)) {
         PrintHelp();
         return -1;
     }
 
-    /* Copy argument 2 into our own string string while converting to lower case. */
-    memset(string, 0, sizeof(string));
-    for (i = 0; i < len; i++) {
-        string[i] = ToLower(argv[1][i]);
+    /* Check for the stream mode, it takes no value argument. */
+    if (streamBase != '\0') {
+        if ((argi != argc) || (rangeArgument != NULL) || (layoutPath != NULL)) {
+            PrintHelp();
+            return -1;
+        }
+
+        return FlushOutput(ConvertStream(streamBase, separators, stdin, stdout));
     }
-    /* From this point on we don't have to use ToLower any more. */
 
-    retval = CheckString(string, len, &base);
-    if (retval != 0) {
+    /* Check for the range mode, it takes no value argument. */
+    if (rangeArgument != NULL) {
+        if ((argi != argc) || (layoutPath != NULL) || (ParseRange(rangeArgument, separators, &range) != 0)) {
+            PrintHelp();
+            return -1;
+        }
+
+        return FlushOutput(WriteRange(&range, (uint32_t)threadCount, stdout));
+    }
+
+    /* Check argument. */
+    if ((argc - argi) != 1) {
+        /* Missing or too many arguments. */
         PrintHelp();
-        return retval;
+        return -1;
     }
 
-    ParseString(string, len, &number, base);
+    /* Check for the layout mode, for a single value or for all values on stdin. */
+    if (layoutPath != NULL) {
+        retval = LoadLayout(layoutPath, &layout);
+        if (retval > 0) {
+            fprintf(stderr, "%s: layout line %d invalid\n", layoutPath, retval);
+        } else if (retval != 0) {
+            fprintf(stderr, "%s: layout can not be read\n", layoutPath);
+        }
+        if (retval != 0) {
+            PrintHelp();
+            return -1;
+        }
 
-    PrintNumerals(number);
+        if (strcmp(argv[argi], "-") == 0) {
+            return FlushOutput(DecodeStream(&layout, separators, stdin, stdout));
+        }
 
-    return 0;
+        return PrintFields(&layout, argv[argi], separators);
+    }
+
+    /* Convert the argument into either the numerals or the help menu. */
+    retval = ConvertArgument(argv[argi], separators, output, &len);
+
+    if ((WriteOutput(output, len) != 0) && (retval == 0)) {
+        retval = -1;
+    }
+
+    return retval;
 }
@@ -0,0 +1,899 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "version.h"
+#include "numconvert.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define COMPACT_BLOCK_SIZE  16u /* The number of characters CompactString() handles at once. */
+
+/* UINT64_MAX equivalent string. */
+static const char *DecimalStringValueMax = "18446744073709551615";
+
+/* Lowercase Hexadecimal digits, indexed by nibble value. */
+static const char HexadecimalDigits[] = "0123456789abcdef";
+
+/* The help menu, the version is folded in at compile time. */
+static const char HelpText[] =
+    "Version " VERSION_STRING "\n\n"
+    "Usage:\n"
+    "  numconvert [--separators <chars>] [prefix]<value>[postfix]\n"
+    "  numconvert [--separators <chars>] --layout <file> [prefix]<value>[postfix] | -\n"
+    "  numconvert [--separators <chars>] [--threads <n>] --range <start>:<end>[:<step>]\n"
+    "  numconvert [--separators <chars>] --stream <bin2hex|hex2bin> < <input>\n"
+    "  numconvert --shm <name>\n"
+    "\nNo prefix/postfix:\n"
+    "            to indicate a decimal value\n"
+    "\nPrefixes:\n"
+    "  0x or 0X, to indicate a hexadecimal value\n"
+    "\nPostfixes:\n"
+    "  b or B,   to indicate a binary value\n"
+    "  h or H,   to indicate a hexadecimal value\n"
+    "\nOptions:\n"
+    "  --separators <chars>, ignore the digit separators <chars> in <value>, f.e. \"_',\"\n"
+    "  --layout <file>,      decode <value> into the register fields described in <file>,\n"
+    "                        or every value on stdin for -\n"
+    "  --range <start>:<end>[:<step>],\n"
+    "                        print every value from <start> up to <end> in all bases\n"
+    "  --threads <n>,        format the range with <n> threads (1 - 64)\n"
+    "  --stream <bin2hex|hex2bin>,\n"
+    "                        convert a digit stream of any length from stdin to stdout\n"
+    "  --shm <name>,         serve conversions from the shared-memory ring <name>\n\n";
+
+static bool IsBinaryChar(char c);
+static bool IsDecimalChar(char c);
+static bool IsHexadecimalChar(char c);
+static void ParseBinary(const char *string, size_t len, uint64_t *number);
+static void ParseDecimal(const char *string, size_t len, uint64_t *number);
+static void ParseHexadecimal(const char *string, size_t len, uint64_t *number);
+static bool IsBinary(const char *string, size_t len);
+static bool IsDecimal(const char *string, size_t len);
+static bool IsHexadecimal(const char *string, size_t len);
+static bool IsSeparator(char c, const char *separators, size_t separatorCount);
+static size_t CompactString(const char *string, size_t len, const char *separators, char *compact);
+static int CheckSeparatorPositions(const char *string, size_t len, const char *separators);
+
+/*!
+ * \brief Convert a character to it's lowercase equivalent (when required).
+ * \param c
+ *      The character to convert.
+ * \returns
+ *      The lowercase equivalent of c or c when no conversion was required.
+ */
+char ToLower(char c)
+{
+    if ((c >= 'A') && (c <= 'Z')) {
+        c = (char)(c + 0x20);
+    }
+
+    return c;
+}
+
+/*!
+ * \brief Indicate if a character represents a valid Binary character.
+ * \param c
+ *      The character to verify.
+ * \returns
+ *      true if the character represents a valid Binary character, otherwise false.
+ */
+static bool IsBinaryChar(char c)
+{
+    bool isBinaryChar = false;
+
+    if ((c == '0') || (c == '1')) {
+        isBinaryChar = true;
+    }
+
+    return isBinaryChar;
+}
+
+/*!
+ * \brief Indicate if a character represents a valid Decimal character.
+ * \param c
+ *      The character to verify.
+ * \returns
+ *      true if the character represents a valid Decimal character, otherwise false.
+ */
+static bool IsDecimalChar(char c)
+{
+    bool isDecimalChar = false;
+
+    if ((c >= '0') && (c <= '9')) {
+        isDecimalChar = true;
+    }
+
+    return isDecimalChar;
+}
+
+/*!
+ * \brief Indicate if a character represents a valid Hexadecimal character.
+ * \param c
+ *      The character to verify.
+ * \returns
+ *      true if the character represents a valid Hexadecimal character, otherwise false.
+ */
+static bool IsHexadecimalChar(char c)
+{
+    bool isHexaDecimalChar = false;
+
+    if ((IsDecimalChar(c) == true) ||
+        ((c >= 'a') && (c <= 'f'))) {
+        isHexaDecimalChar = true;
+    }
+
+    return isHexaDecimalChar;
+}
+
+/*!
+ * \brief Parse a string that represents a Binary value and returns its value.
+ * \param string
+ *      The string to parse.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string.
+ */
+static void ParseBinary(const char *string, size_t len, uint64_t *number)
+{
+    int64_t i = 0;
+
+    *number = 0;
+
+    for (i = ((int64_t)len - 1); i >= 0; i--) {
+        if (string[i] == '1') {
+            *number += (uint64_t)1 << (len - 2 - i);
+        }
+    }
+}
+
+/*!
+ * \brief Parse a string that represents a Decimal value and returns its value.
+ * \param string
+ *      The string to parse.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string.
+ */
+static void ParseDecimal(const char *string, size_t len, uint64_t *number)
+{
+    uint64_t val = 0;
+    int64_t i = 0;
+    uint64_t value = 0;
+
+    *number = 0;
+
+    val = 1;
+    for (i = ((int64_t)len - 1); i >= 0; i--) {
+        value = (string[i] - 0x30) * val;
+        *number += value;
+        val *= 10;
+    }
+}
+
+/*!
+ * \brief Parse a string that represents a Hexadecimal value and returns its value.
+ * \param string
+ *      The string to parse.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string.
+ */
+static void ParseHexadecimal(const char *string, size_t len, uint64_t *number)
+{
+    int64_t i = 0;
+    uint64_t value = 0;
+    uint64_t start = 0;
+    int64_t end = 0;
+
+    *number = 0;
+
+    if (string[len - 1] == 'h') {
+        start = len - 2;
+        end = 0;
+    } else { /* starts with 0x */
+        start = len - 1;
+        end = 2;
+    }
+
+    for (i = (int64_t)start; i >= end; i--) {
+        switch (string[i]) {
+            case 'a':
+            case 'b':
+            case 'c':
+            case 'd':
+            case 'e':
+                /* No break. */
+            case 'f':
+                value = (uint64_t)string[i] - 0x61 + 10;
+                break;
+            default:
+                value = (uint64_t)string[i] - 0x30;
+                break;
+        }
+        *number |= value << ((start - i) * 4);
+    }
+}
+
+/*!
+ * \brief Indicate if a string represents a valid Binary value.
+ * \param string
+ *      The string to verify.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \returns
+ *      true if the string represents a valid Binary value, otherwise false.
+ */
+static bool IsBinary(const char *string, size_t len)
+{
+    bool isBinary = false;
+    uint64_t i = 0;
+
+    if (string[len - 1] == 'b') {
+        isBinary = true;
+        for (i = 0; i < (len - 1); i++) {
+            if (IsBinaryChar(string[i]) == false) {
+                isBinary = false;
+                break;
+            }
+        }
+    }
+
+    if (isBinary == true) {
+        /* No need to check for maximum length:
+         * - (len >= BINARY_STRING_LEN_MAX + 1), or BUFFER_SIZE, is covered by the caller of CheckString()
+         */
+        if (len < 2) {
+            /* This isn't gonna fit in UINT64_MAX. */
+            isBinary = false;
+        }
+    }
+
+    return isBinary;
+}
+
+/*!
+ * \brief Indicate if a string represents a valid Decimal value.
+ * \param string
+ *      The string to verify.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \returns
+ *      true if the string represents a valid Decimal value, otherwise false.
+ */
+static bool IsDecimal(const char *string, size_t len)
+{
+    bool isDecimal = true;
+    uint64_t i = 0;
+
+    for (i = 0; i < len; i++) {
+        if (IsDecimalChar(string[i]) == false) {
+            isDecimal = false;
+            break;
+        }
+    }
+
+    if (isDecimal == true) {
+        /* No need to check for minimum length:
+         * - (len == 0) is covered by CheckString()
+         */
+        if (len == DECIMAL_STRING_LEN_MAX) {
+            for (i = 0; i < DECIMAL_STRING_LEN_MAX; i++) {
+                if ((string[i] - 0x30) > (DecimalStringValueMax[i] - 0x30)) {
+                    /* This isn't gonna fit in UINT64_MAX. */
+                    isDecimal = false;
+                    break;
+                } else if ((string[i] - 0x30) == (DecimalStringValueMax[i] - 0x30)) {
+                    /* Continue checking the lower digits, it can still become too large. */
+                    continue;
+                } else {
+                    /* No need to continue checking the lower digits, it cannot become too large. */
+                    break;
+                }
+            }
+        } else if (len > DECIMAL_STRING_LEN_MAX) {
+            isDecimal = false;
+        }
+        /* else: will not happen because it's protected by CheckString(). */
+    }
+
+    return isDecimal;
+}
+
+/*!
+ * \brief Indicate if a string represents a valid Hexadecimal value.
+ * \param string
+ *      The string to verify.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \returns
+ *      true if the string represents a valid Hexadecimal value, otherwise false.
+ */
+static bool IsHexadecimal(const char *string, size_t len)
+{
+    bool isHexaDecimal = true;
+    uint64_t i = 0;
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t minLen = 0;
+    uint64_t maxLen = 0;
+
+    if (string[len - 1] == 'h') {
+        start = 0;
+        end = len - 1;
+        minLen = 2;
+        maxLen = HEXADECIMAL_H_STRING_LEN_MAX;
+    } else if ((string[0] == '0') && (string[1] == 'x')) {
+        start = 2;
+        end = len;
+        minLen = 3;
+        maxLen = HEXADECIMAL_0X_STRING_LEN_MAX;
+    } else {
+        isHexaDecimal = false;
+    }
+
+    if (isHexaDecimal == true) {
+        for (i = start; i < end; i++) {
+            if (IsHexadecimalChar(string[i]) == false) {
+                isHexaDecimal = false;
+                break;
+            }
+        }
+    }
+
+    if (isHexaDecimal == true) {
+        if ((len < minLen) ||
+            (len > maxLen)) {
+            /* This isn't gonna fit in UINT64_MAX. */
+            isHexaDecimal = false;
+        }
+    }
+
+    return isHexaDecimal;
+}
+
+/*!
+ * \brief Parse an input string and return it's represented value as a number.
+ * \param string
+ *      The input string to parse.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string in case it checked-out.
+ * \param base
+ *      The base of the numeric string.
+ */
+void ParseString(const char *string, size_t len, uint64_t *number, const char base)
+{
+    if (base == 'd') {
+        ParseDecimal(string, len, number);
+    } else if (base == 'h') {
+        ParseHexadecimal(string, len, number);
+    } else {
+        /* base == 'b' is the only one left.
+         * Nothing else will happen because it's protected by CheckString().
+         */
+        ParseBinary(string, len, number);
+    }
+}
+
+/*!
+ * \brief Check an input string to be an expected numeric string.
+ * \param string
+ *      The input string to check.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] base
+ *      The base of the numeric string in case it checked-out.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int CheckString(const char *string, size_t len, char *base)
+{
+    /* Is the len okay? */
+    if (len == 0) {
+        return -1;
+    }
+
+    /* Is Binary? */
+    if (IsBinary(string, len) == true) {
+        *base = 'b';
+        return 0;
+    }
+
+    /* Is Decimal? */
+    if (IsDecimal(string, len) == true) {
+        *base = 'd';
+        return 0;
+    }
+
+    /* Is Hexadecimal? */
+    if (IsHexadecimal(string, len) == true) {
+        *base = 'h';
+        return 0;
+    }
+
+    /* Is none of the above. */
+    return -1;
+}
+
+
+/*!
+ * \brief Format a number as 64 Binary digits, grouped per nibble.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least BINARY_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatBinary(uint64_t number, char *buf)
+{
+    int64_t i = 0;
+    size_t len = 0;
+
+    for (i = 63; i >= 0; i--) {
+        buf[len++] = (char)('0' + ((number >> i) & 0x1));
+
+        if ((i % 4 == 0) && (i != 0)) {
+            buf[len++] = ' ';
+        }
+    }
+    buf[len] = '\0';
+
+    return len;
+}
+
+/*!
+ * \brief Format a number as Decimal digits.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least DECIMAL_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatDecimal(uint64_t number, char *buf)
+{
+    char digits[DECIMAL_STRING_LEN_MAX];
+    size_t len = 0;
+    size_t i = 0;
+
+    /* Collect the digits from least to most significant. */
+    do {
+        digits[len++] = (char)('0' + (number % 10u));
+        number /= 10u;
+    } while (number != 0u);
+
+    for (i = 0; i < len; i++) {
+        buf[i] = digits[len - 1 - i];
+    }
+    buf[len] = '\0';
+
+    return len;
+}
+
+/*!
+ * \brief Format a number as 0x prefixed Hexadecimal digits.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least HEXADECIMAL_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatHexadecimal(uint64_t number, char *buf)
+{
+    int64_t shift = 60;
+    size_t len = 0;
+
+    buf[len++] = '0';
+    buf[len++] = 'x';
+
+    /* Skip the leading zero nibbles, but always print at least one digit. */
+    while ((shift > 0) && (((number >> shift) & 0xf) == 0)) {
+        shift -= 4;
+    }
+
+    for (; shift >= 0; shift -= 4) {
+        buf[len++] = HexadecimalDigits[(number >> shift) & 0xf];
+    }
+    buf[len] = '\0';
+
+    return len;
+}
+
+/*!
+ * \brief Format a number in the requested base.
+ * \param number
+ *      The number to format.
+ * \param base
+ *      The output base, 'b', 'd' or 'h'.
+ * \param[out] buf
+ *      The output buffer, at least BINARY_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator) or 0 in case of an
+ *      unknown base.
+ */
+size_t FormatNumber(uint64_t number, char base, char *buf)
+{
+    size_t len = 0;
+
+    if (base == 'd') {
+        len = FormatDecimal(number, buf);
+    } else if (base == 'h') {
+        len = FormatHexadecimal(number, buf);
+    } else if (base == 'b') {
+        len = FormatBinary(number, buf);
+    } else {
+        buf[0] = '\0';
+    }
+
+    return len;
+}
+
+/*!
+ * \brief Format a number in Binary, Decimal and Hexadecimal as it is printed to the console.
+ * \details
+ *      The Binary value is split over 2 lines of 32 bits each, every nibble followed by a space.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least NUMERALS_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatNumerals(uint64_t number, char *buf)
+{
+    char binary[BINARY_FORMAT_SIZE];
+    size_t len = 0;
+
+    (void)FormatBinary(number, binary);
+
+    /* Decimal. */
+    memcpy(&buf[len], "\nDecimal:\n  ", 12);
+    len += 12;
+    len += FormatDecimal(number, &buf[len]);
+    buf[len++] = '\n';
+
+    /* Binary, the upper 8 nibbles include the space that separates them from the lower 8. */
+    memcpy(&buf[len], "Binary:\n  ", 10);
+    len += 10;
+    memcpy(&buf[len], &binary[0], 40);
+    len += 40;
+    memcpy(&buf[len], "\n  ", 3);
+    len += 3;
+    memcpy(&buf[len], &binary[40], 39);
+    len += 39;
+    memcpy(&buf[len], " \n", 2);
+    len += 2;
+
+    /* Hexadecimal. */
+    memcpy(&buf[len], "Hexadecimal:\n  ", 15);
+    len += 15;
+    len += FormatHexadecimal(number, &buf[len]);
+    memcpy(&buf[len], "\n\n", 3);
+    len += 2;
+
+    return len;
+}
+
+/*!
+ * \brief Indicate if a character is one of the digit separators.
+ * \param c
+ *      The character to verify.
+ * \param separators
+ *      The separator characters.
+ * \param separatorCount
+ *      The number of separator characters.
+ * \returns
+ *      true if the character is a separator, otherwise false.
+ */
+static bool IsSeparator(char c, const char *separators, size_t separatorCount)
+{
+    bool isSeparator = false;
+    size_t i = 0;
+
+    for (i = 0; i < separatorCount; i++) {
+        if (c == separators[i]) {
+            isSeparator = true;
+            break;
+        }
+    }
+
+    return isSeparator;
+}
+
+/*!
+ * \brief Copy a string while converting to lowercase and removing the digit separators.
+ * \details
+ *      With SSE2, blocks of COMPACT_BLOCK_SIZE characters are converted and compared against all
+ *      separators at once. A block without separators is stored as a whole, otherwise the
+ *      separator mask selects the characters to keep. The remainder is handled per character.
+ *
+ *      Compaction stops as soon as the result is too long to be a numeric string.
+ * \param string
+ *      The string to copy.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param separators
+ *      The separator characters or NULL for none.
+ * \param[out] compact
+ *      The compacted string, at least BUFFER_SIZE + COMPACT_BLOCK_SIZE bytes. Not terminated.
+ * \returns
+ *      The length of the compacted string, BUFFER_SIZE or more in case it is too long.
+ */
+static size_t CompactString(const char *string, size_t len, const char *separators, char *compact)
+{
+    size_t separatorCount = 0;
+    size_t compactLen = 0;
+    size_t i = 0;
+    char c = '\0';
+#if defined(__SSE2__)
+    __m128i separatorBlocks[SEPARATORS_MAX];
+    __m128i block;
+    __m128i isUpper;
+    __m128i isSeparator;
+    char chars[COMPACT_BLOCK_SIZE];
+    uint32_t keep = 0;
+    size_t j = 0;
+#endif
+
+    if (separators != NULL) {
+        separatorCount = strlen(separators);
+    }
+
+#if defined(__SSE2__)
+    for (j = 0; j < separatorCount; j++) {
+        separatorBlocks[j] = _mm_set1_epi8(separators[j]);
+    }
+
+    for (; ((i + COMPACT_BLOCK_SIZE) <= len) && (compactLen < BUFFER_SIZE);
+         i += COMPACT_BLOCK_SIZE) {
+        block = _mm_loadu_si128((const __m128i *)&string[i]);
+
+        /* ToLower: add 0x20 to 'A' - 'Z' (signed compares, characters >= 0x80 are negative). */
+        isUpper = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)),
+                                _mm_cmplt_epi8(block, _mm_set1_epi8('Z' + 1)));
+        block = _mm_add_epi8(block, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+
+        isSeparator = _mm_setzero_si128();
+        for (j = 0; j < separatorCount; j++) {
+            isSeparator = _mm_or_si128(isSeparator, _mm_cmpeq_epi8(block, separatorBlocks[j]));
+        }
+
+        keep = ~(uint32_t)_mm_movemask_epi8(isSeparator) & 0xffffu;
+        if (keep == 0xffffu) {
+            _mm_storeu_si128((__m128i *)&compact[compactLen], block);
+            compactLen += COMPACT_BLOCK_SIZE;
+        } else {
+            _mm_storeu_si128((__m128i *)chars, block);
+            while (keep != 0) {
+                compact[compactLen++] = chars[__builtin_ctz(keep)];
+                keep &= keep - 1u;
+            }
+        }
+    }
+#endif
+
+    for (; (i < len) && (compactLen < BUFFER_SIZE); i++) {
+        c = ToLower(string[i]);
+        if (IsSeparator(c, separators, separatorCount) == false) {
+            compact[compactLen++] = c;
+        }
+    }
+
+    return compactLen;
+}
+
+/*!
+ * \brief Check that every digit separator in a string is between two digits.
+ * \details
+ *      The digits are the characters behind the 0x prefix or before the b/h postfix, so a
+ *      separator inside or next to the prefix or postfix is rejected, f.e. "0_x10" or "10_b".
+ *      Consecutive separators count as one.
+ * \param string
+ *      The numeric string to verify, in any case.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param separators
+ *      The separator characters.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int CheckSeparatorPositions(const char *string, size_t len, const char *separators)
+{
+    size_t separatorCount = strlen(separators);
+    size_t digitsStart = 0;
+    size_t digitsEnd = len;
+    size_t i = 0;
+    bool isDigit = false;
+    bool isPreviousDigit = false;
+    bool isSeparated = false;
+    char c = '\0';
+
+    if ((len >= 2u) && (string[0] == '0') && (ToLower(string[1]) == 'x')) {
+        digitsStart = 2u;
+    } else if ((len >= 1u) && ((ToLower(string[len - 1u]) == 'b') ||
+                               (ToLower(string[len - 1u]) == 'h'))) {
+        digitsEnd = len - 1u;
+    }
+
+    for (i = 0; i < len; i++) {
+        c = ToLower(string[i]);
+        if (IsSeparator(c, separators, separatorCount) == true) {
+            if (isPreviousDigit == false) {
+                return -1;
+            }
+            isSeparated = true;
+        } else {
+            isDigit = (i >= digitsStart) && (i < digitsEnd) && (IsHexadecimalChar(c) == true);
+            if ((isSeparated == true) && (isDigit == false)) {
+                return -1;
+            }
+            isSeparated = false;
+            isPreviousDigit = isDigit;
+        }
+    }
+
+    return (isSeparated == true) ? -1 : 0;
+}
+
+/*!
+ * \brief Convert a numeric string, in any case, to the number it represents.
+ * \details
+ *      Combines the length check, lowercase conversion, CheckString() and ParseString().
+ * \param string
+ *      The numeric string to convert.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string in case it checked-out.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ConvertString(const char *string, size_t len, uint64_t *number)
+{
+    return ConvertSeparatedString(string, len, NULL, number);
+}
+
+/*!
+ * \brief Check a set of digit separator characters.
+ * \param separators
+ *      The separator characters, f.e. "_',". Digits, letters and signs are not allowed.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int CheckSeparators(const char *separators)
+{
+    size_t len = strlen(separators);
+    size_t i = 0;
+    char c = '\0';
+
+    if ((len == 0) || (len > SEPARATORS_MAX)) {
+        return -1;
+    }
+
+    for (i = 0; i < len; i++) {
+        c = ToLower(separators[i]);
+        if ((IsDecimalChar(c) == true) || ((c >= 'a') && (c <= 'z')) || (c == '-') || (c == '+')) {
+            /* This would change the meaning of the numeric string. */
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * \brief Convert a numeric string with digit separators, in any case, to the number it represents.
+ * \details
+ *      The separators are removed in the same pass as the lowercase conversion, the length limits
+ *      apply to the remaining characters. F.e. "0xdead_beef" with separators "_". Separators are
+ *      only allowed between digits, see CheckSeparatorPositions().
+ * \param string
+ *      The numeric string to convert.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param separators
+ *      The separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param[out] number
+ *      The number represented by the numeric string in case it checked-out.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ConvertSeparatedString(const char *string, size_t len, const char *separators,
+                           uint64_t *number)
+{
+    char base = '\0';
+    char compact[BUFFER_SIZE + COMPACT_BLOCK_SIZE];
+    size_t compactLen = 0;
+    int retval = 0;
+
+    /* Copy the string while converting to lower case and removing the separators. */
+    compactLen = CompactString(string, len, separators, compact);
+    if (compactLen >= BUFFER_SIZE) {
+        return -1;
+    }
+
+    /* Only strings that had separators removed need their positions checked. */
+    if ((compactLen != len) && (CheckSeparatorPositions(string, len, separators) != 0)) {
+        return -1;
+    }
+    len = compactLen;
+    compact[len] = '\0';
+    /* From this point on we don't have to use ToLower any more. */
+
+    retval = CheckString(compact, len, &base);
+    if (retval != 0) {
+        return retval;
+    }
+
+    ParseString(compact, len, number, base);
+
+    return 0;
+}
+
+/*!
+ * \brief Format the help menu as it is printed to the console.
+ * \param[out] buf
+ *      The output buffer, at least OUTPUT_BUFFER_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatHelp(char *buf)
+{
+    memcpy(buf, HelpText, sizeof(HelpText));
+
+    return sizeof(HelpText) - 1u;
+}
+
+/*!
+ * \brief Convert a command line argument into the complete console output.
+ * \param argument
+ *      The command line argument, f.e. "0x12" or "1010B".
+ * \param separators
+ *      The separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param[out] output
+ *      The console output, either the numerals or the help menu. At least OUTPUT_BUFFER_SIZE bytes.
+ * \param[out] len
+ *      The length of the console output (excluding the string terminator).
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ConvertArgument(const char *argument, const char *separators, char *output, size_t *len)
+{
+    uint64_t number = 0;
+    int retval = 0;
+
+    retval = ConvertSeparatedString(argument, strlen(argument), separators, &number);
+    if (retval != 0) {
+        *len = FormatHelp(output);
+        return retval;
+    }
+
+    *len = FormatNumerals(number, output);
+
+    return 0;
+}
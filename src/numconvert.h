@@ -0,0 +1,198 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NUMCONVERT_H__
+#define NUMCONVERT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BINARY_STRING_LEN_MAX           65u
+#define DECIMAL_STRING_LEN_MAX          20u
+#define HEXADECIMAL_H_STRING_LEN_MAX    17u
+#define HEXADECIMAL_0X_STRING_LEN_MAX   18u
+#define BUFFER_SIZE                     (BINARY_STRING_LEN_MAX + 1u) /* + string terminator. */
+
+#define BINARY_FORMAT_SIZE              80u  /* 16 nibbles + 15 spaces + string terminator. */
+#define DECIMAL_FORMAT_SIZE             21u  /* 20 digits + string terminator. */
+#define HEXADECIMAL_FORMAT_SIZE         19u  /* 0x + 16 digits + string terminator. */
+#define NUMERALS_FORMAT_SIZE            256u /* The complete console output of FormatNumerals(). */
+#define OUTPUT_BUFFER_SIZE              2048u /* The complete console output of ConvertArgument(). */
+#define SEPARATORS_MAX                  8u   /* The maximum number of digit separator characters. */
+
+/*!
+ * \brief Convert a character to it's lowercase equivalent (when required).
+ * \param c
+ *      The character to convert.
+ * \returns
+ *      The lowercase equivalent of c or c when no conversion was required.
+ */
+char ToLower(char c);
+
+/*!
+ * \brief Check an input string to be an expected numeric string.
+ * \param string
+ *      The input string to check, in lowercase.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] base
+ *      The base of the numeric string in case it checked-out.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int CheckString(const char *string, size_t len, char *base);
+
+/*!
+ * \brief Parse an input string and return it's represented value as a number.
+ * \param string
+ *      The input string to parse, it must have been accepted by CheckString().
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string.
+ * \param base
+ *      The base of the numeric string as returned by CheckString().
+ */
+void ParseString(const char *string, size_t len, uint64_t *number, char base);
+
+/*!
+ * \brief Convert a numeric string, in any case, to the number it represents.
+ * \details
+ *      Combines the length check, lowercase conversion, CheckString() and ParseString().
+ * \param string
+ *      The numeric string to convert.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string in case it checked-out.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ConvertString(const char *string, size_t len, uint64_t *number);
+
+/*!
+ * \brief Check a set of digit separator characters.
+ * \param separators
+ *      The separator characters, f.e. "_',". Digits, letters and signs are not allowed.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int CheckSeparators(const char *separators);
+
+/*!
+ * \brief Convert a numeric string with digit separators, in any case, to the number it represents.
+ * \details
+ *      The separators are removed in the same pass as the lowercase conversion, the length limits
+ *      apply to the remaining characters. F.e. "0xdead_beef" with separators "_". Separators are
+ *      only allowed between digits, not inside or next to the prefix or postfix.
+ * \param string
+ *      The numeric string to convert.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param separators
+ *      The separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param[out] number
+ *      The number represented by the numeric string in case it checked-out.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ConvertSeparatedString(const char *string, size_t len, const char *separators,
+                           uint64_t *number);
+
+/*!
+ * \brief Format a number as 64 Binary digits, grouped per nibble.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least BINARY_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatBinary(uint64_t number, char *buf);
+
+/*!
+ * \brief Format a number as Decimal digits.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least DECIMAL_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatDecimal(uint64_t number, char *buf);
+
+/*!
+ * \brief Format a number as 0x prefixed Hexadecimal digits.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least HEXADECIMAL_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatHexadecimal(uint64_t number, char *buf);
+
+/*!
+ * \brief Format a number in the requested base.
+ * \param number
+ *      The number to format.
+ * \param base
+ *      The output base, 'b', 'd' or 'h'.
+ * \param[out] buf
+ *      The output buffer, at least BINARY_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator) or 0 in case of an
+ *      unknown base.
+ */
+size_t FormatNumber(uint64_t number, char base, char *buf);
+
+/*!
+ * \brief Format a number in Binary, Decimal and Hexadecimal as it is printed to the console.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least NUMERALS_FORMAT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatNumerals(uint64_t number, char *buf);
+
+/*!
+ * \brief Format the help menu as it is printed to the console.
+ * \param[out] buf
+ *      The output buffer, at least OUTPUT_BUFFER_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t FormatHelp(char *buf);
+
+/*!
+ * \brief Convert a command line argument into the complete console output.
+ * \param argument
+ *      The command line argument, f.e. "0x12" or "1010B".
+ * \param separators
+ *      The separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param[out] output
+ *      The console output, either the numerals or the help menu. At least OUTPUT_BUFFER_SIZE bytes.
+ * \param[out] len
+ *      The length of the console output (excluding the string terminator).
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ConvertArgument(const char *argument, const char *separators, char *output, size_t *len);
+
+#endif /* NUMCONVERT_H__ */
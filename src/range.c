@@ -0,0 +1,534 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "numconvert.h"
+#include "range.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#define COUNTER_DIGITS      64u /* Enough for UINT64_MAX in Binary. */
+#define COUNTER_SIZE        (COUNTER_DIGITS + RANGE_BLOCK_SLACK) /* Digits + room for FixedCopy(). */
+#define RANGE_PARTS_MAX     3u  /* <start>:<end>:<step> */
+
+/*!
+ * \brief A number as right-aligned digit characters that can be incremented in place.
+ */
+typedef struct {
+    char digits[COUNTER_SIZE];      /*!< The digits, the least significant one at index 63. */
+    size_t first;                   /*!< The index of the most significant digit. */
+} Counter;
+
+/*!
+ * \brief The step of a range as digit values, least significant first.
+ */
+typedef struct {
+    uint8_t digits[COUNTER_DIGITS]; /*!< The digit values. */
+    size_t len;                     /*!< The number of digits. */
+} Step;
+
+#ifndef _WIN32
+/*!
+ * \brief The state of a formatting thread and its two output buffers.
+ */
+typedef struct {
+    const Range *range;             /*!< The range that is being written. */
+    uint64_t blockCount;            /*!< The total number of blocks in the range. */
+    uint32_t threadCount;           /*!< The total number of formatting threads. */
+    uint32_t index;                 /*!< The index of this thread. */
+    pthread_t thread;               /*!< The thread. */
+    pthread_mutex_t mutex;          /*!< Protects blockIds and abort. */
+    pthread_cond_t cond;            /*!< Signalled on every change of blockIds or abort. */
+    char *buffers[2];               /*!< The output buffers, used alternately. */
+    size_t lens[2];                 /*!< The number of bytes in every buffer. */
+    uint64_t blockIds[2];           /*!< The block held by every buffer, UINT64_MAX when empty. */
+    bool abort;                     /*!< Set by the writer to stop formatting. */
+} Worker;
+#endif
+
+/* Maps a lowercase digit character onto its value. */
+static const uint8_t DigitValues[256] = {
+    ['0'] = 0, ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4, ['5'] = 5, ['6'] = 6, ['7'] = 7,
+    ['8'] = 8, ['9'] = 9, ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+};
+
+/* Maps a digit value onto its lowercase character. */
+static const char DigitChars[] = "0123456789abcdef";
+
+static inline size_t CounterCopy(const Counter *counter, char *buf, size_t copySize);
+static void CounterInit(Counter *counter, uint64_t number, uint32_t base);
+static void CounterAdd(Counter *counter, const Step *step, uint32_t base);
+static void StepInit(Step *step, uint64_t number, uint32_t base);
+static int WriteBlocks(const Range *range, FILE *fp);
+#ifndef _WIN32
+static void* WorkerMain(void *arg);
+static int WriteBlocksThreaded(const Range *range, uint32_t threadCount, FILE *fp);
+#endif
+
+/*!
+ * \brief Copy the digits of a counter.
+ * \details
+ *      Copies a fixed number of bytes, which the compiler turns into a few vector moves instead of
+ *      a variable length memcpy() call. Up to copySize bytes behind the digits in buf are
+ *      overwritten.
+ * \param counter
+ *      The counter.
+ * \param[out] buf
+ *      The output buffer.
+ * \param copySize
+ *      A compile-time constant of at least the maximum number of digits in the counter's base.
+ * \returns
+ *      The number of digits.
+ */
+static inline size_t CounterCopy(const Counter *counter, char *buf, size_t copySize)
+{
+    memcpy(buf, &counter->digits[counter->first], copySize);
+
+    return COUNTER_DIGITS - counter->first;
+}
+
+/*!
+ * \brief Set a counter to a number.
+ * \param[out] counter
+ *      The counter.
+ * \param number
+ *      The number.
+ * \param base
+ *      2, 10 or 16.
+ */
+static void CounterInit(Counter *counter, uint64_t number, uint32_t base)
+{
+    size_t i = COUNTER_DIGITS;
+
+    do {
+        i--;
+        counter->digits[i] = DigitChars[number % base];
+        number /= base;
+    } while (number != 0);
+
+    counter->first = i;
+}
+
+/*!
+ * \brief Add the step to a counter, in place with carry propagation.
+ * \details
+ *      The caller must make sure that the sum fits in an uint64_t.
+ * \param[in,out] counter
+ *      The counter.
+ * \param step
+ *      The step, in the same base.
+ * \param base
+ *      2, 10 or 16.
+ */
+static void CounterAdd(Counter *counter, const Step *step, uint32_t base)
+{
+    size_t i = COUNTER_DIGITS - 1u;
+    size_t k = 0;
+    uint32_t digit = 0;
+    uint32_t carry = 0;
+
+    /* Most additions only change the least significant digit. */
+    digit = (uint32_t)DigitValues[(uint8_t)counter->digits[i]] + step->digits[0];
+    if ((step->len == 1u) && (digit < base)) {
+        counter->digits[i] = DigitChars[digit];
+        return;
+    }
+
+    for (k = 0; (k < step->len) || (carry != 0); k++, i--) {
+        digit = carry;
+        if (i >= counter->first) {
+            digit += DigitValues[(uint8_t)counter->digits[i]];
+        }
+        if (k < step->len) {
+            digit += step->digits[k];
+        }
+
+        carry = 0;
+        if (digit >= base) {
+            digit -= base;
+            carry = 1;
+        }
+
+        counter->digits[i] = DigitChars[digit];
+        if (i < counter->first) {
+            /* The number grew a digit. */
+            counter->first = i;
+        }
+    }
+}
+
+/*!
+ * \brief Split a step into its digit values.
+ * \param[out] step
+ *      The step.
+ * \param number
+ *      The step size.
+ * \param base
+ *      2, 10 or 16.
+ */
+static void StepInit(Step *step, uint64_t number, uint32_t base)
+{
+    step->len = 0;
+
+    do {
+        step->digits[step->len++] = (uint8_t)(number % base);
+        number /= base;
+    } while (number != 0);
+}
+
+/*!
+ * \brief Parse a range argument.
+ * \param string
+ *      The range argument "<start>:<end>[:<step>]", every part as accepted on the command line.
+ * \param separators
+ *      The digit separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param[out] range
+ *      The parsed range.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ParseRange(const char *string, const char *separators, Range *range)
+{
+    uint64_t numbers[RANGE_PARTS_MAX] = { 0, 0, 1 };
+    const char *part = string;
+    const char *colon = NULL;
+    uint32_t partCount = 0;
+    uint64_t span = 0;
+
+    while (partCount < RANGE_PARTS_MAX) {
+        colon = strchr(part, ':');
+        if (colon == NULL) {
+            colon = &part[strlen(part)];
+        }
+
+        if (ConvertSeparatedString(part, (size_t)(colon - part), separators,
+                                   &numbers[partCount]) != 0) {
+            return -1;
+        }
+        partCount++;
+
+        if (*colon == '\0') {
+            break;
+        }
+        part = colon + 1;
+    }
+
+    if ((partCount < 2u) || (*colon != '\0')) {
+        /* Missing end or too many parts. */
+        return -1;
+    }
+
+    range->start = numbers[0];
+    range->end = numbers[1];
+    range->step = numbers[2];
+
+    if ((range->start > range->end) || (range->step == 0)) {
+        return -1;
+    }
+
+    span = range->end - range->start;
+    range->count = (span / range->step) + (((span % range->step) != 0) ? 1u : 0u);
+
+    return 0;
+}
+
+/*!
+ * \brief Format a block of consecutive range values, one line per value.
+ * \details
+ *      Every line holds the value in Decimal, Hexadecimal and Binary, f.e. "10 0xa 1010b". Only the
+ *      first value is formatted by division, the next ones are derived by adding the step to the
+ *      digit strings in place.
+ * \param range
+ *      The range.
+ * \param first
+ *      The index of the first value in the range.
+ * \param count
+ *      The number of values to format, first + count must not exceed range->count.
+ * \param[out] buf
+ *      The output buffer, at least count * RANGE_LINE_SIZE_MAX + RANGE_BLOCK_SLACK bytes.
+ * \returns
+ *      The number of bytes written to buf.
+ */
+size_t FormatRangeBlock(const Range *range, uint64_t first, uint64_t count, char *buf)
+{
+    Counter decimal;
+    Counter hexadecimal;
+    Counter binary;
+    Step decimalStep;
+    Step hexadecimalStep;
+    Step binaryStep;
+    uint64_t number = range->start + (first * range->step);
+    uint64_t i = 0;
+    size_t len = 0;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    CounterInit(&decimal, number, 10u);
+    CounterInit(&hexadecimal, number, 16u);
+    CounterInit(&binary, number, 2u);
+    StepInit(&decimalStep, range->step, 10u);
+    StepInit(&hexadecimalStep, range->step, 16u);
+    StepInit(&binaryStep, range->step, 2u);
+
+    for (i = 0; i < count; i++) {
+        len += CounterCopy(&decimal, &buf[len], 32u);
+
+        buf[len++] = ' ';
+        buf[len++] = '0';
+        buf[len++] = 'x';
+        len += CounterCopy(&hexadecimal, &buf[len], 16u);
+
+        buf[len++] = ' ';
+        len += CounterCopy(&binary, &buf[len], 64u);
+        buf[len++] = 'b';
+        buf[len++] = '\n';
+
+        /* The value after the last one may not fit in an uint64_t. */
+        if ((i + 1u) < count) {
+            CounterAdd(&decimal, &decimalStep, 10u);
+            CounterAdd(&hexadecimal, &hexadecimalStep, 16u);
+            CounterAdd(&binary, &binaryStep, 2u);
+        }
+    }
+
+    return len;
+}
+
+/*!
+ * \brief Write all values of a range to a stream, block by block on the calling thread.
+ * \param range
+ *      The range.
+ * \param fp
+ *      The output stream.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int WriteBlocks(const Range *range, FILE *fp)
+{
+    char *buffer = NULL;
+    uint64_t first = 0;
+    uint64_t count = 0;
+    size_t len = 0;
+    int retval = 0;
+
+    buffer = malloc(RANGE_BLOCK_SIZE);
+    if (buffer == NULL) {
+        return -1;
+    }
+
+    for (first = 0; first < range->count; first += count) {
+        count = range->count - first;
+        if (count > RANGE_BLOCK_VALUES) {
+            count = RANGE_BLOCK_VALUES;
+        }
+
+        len = FormatRangeBlock(range, first, count, buffer);
+        if (fwrite(buffer, 1, len, fp) != len) {
+            retval = -1;
+            break;
+        }
+    }
+
+    free(buffer);
+
+    return retval;
+}
+
+#ifndef _WIN32
+/*!
+ * \brief The formatting thread.
+ * \details
+ *      Thread t formats blocks t, t + threadCount, t + 2 * threadCount, ... alternating between its
+ *      two buffers, so it can format a block while the writer writes the previous one.
+ * \param arg
+ *      The Worker of this thread.
+ * \returns
+ *      NULL, always.
+ */
+static void* WorkerMain(void *arg)
+{
+    Worker *worker = arg;
+    uint64_t block = 0;
+    uint64_t first = 0;
+    uint64_t count = 0;
+    uint32_t buffer = 0;
+    size_t len = 0;
+
+    for (block = worker->index; block < worker->blockCount; block += worker->threadCount) {
+        buffer = (uint32_t)((block / worker->threadCount) % 2u);
+
+        /* Wait for the writer to empty the buffer. */
+        pthread_mutex_lock(&worker->mutex);
+        while ((worker->blockIds[buffer] != UINT64_MAX) && (worker->abort == false)) {
+            pthread_cond_wait(&worker->cond, &worker->mutex);
+        }
+        if (worker->abort == true) {
+            pthread_mutex_unlock(&worker->mutex);
+            break;
+        }
+        pthread_mutex_unlock(&worker->mutex);
+
+        first = block * RANGE_BLOCK_VALUES;
+        count = worker->range->count - first;
+        if (count > RANGE_BLOCK_VALUES) {
+            count = RANGE_BLOCK_VALUES;
+        }
+        len = FormatRangeBlock(worker->range, first, count, worker->buffers[buffer]);
+
+        pthread_mutex_lock(&worker->mutex);
+        worker->lens[buffer] = len;
+        worker->blockIds[buffer] = block;
+        pthread_cond_broadcast(&worker->cond);
+        pthread_mutex_unlock(&worker->mutex);
+    }
+
+    return NULL;
+}
+
+/*!
+ * \brief Write all values of a range to a stream, formatted by multiple threads.
+ * \details
+ *      The calling thread writes the blocks in order as they become available.
+ * \param range
+ *      The range.
+ * \param threadCount
+ *      The number of formatting threads, between 2 and RANGE_THREADS_MAX.
+ * \param fp
+ *      The output stream.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int WriteBlocksThreaded(const Range *range, uint32_t threadCount, FILE *fp)
+{
+    Worker workers[RANGE_THREADS_MAX];
+    Worker *worker = NULL;
+    uint64_t blockCount = (range->count + RANGE_BLOCK_VALUES - 1u) / RANGE_BLOCK_VALUES;
+    uint64_t block = 0;
+    uint32_t started = 0;
+    uint32_t buffer = 0;
+    uint32_t i = 0;
+    int retval = 0;
+
+    memset(workers, 0, sizeof(workers));
+
+    for (i = 0; i < threadCount; i++) {
+        worker = &workers[i];
+        worker->range = range;
+        worker->blockCount = blockCount;
+        worker->threadCount = threadCount;
+        worker->index = i;
+        worker->blockIds[0] = UINT64_MAX;
+        worker->blockIds[1] = UINT64_MAX;
+        worker->buffers[0] = malloc(RANGE_BLOCK_SIZE);
+        worker->buffers[1] = malloc(RANGE_BLOCK_SIZE);
+        pthread_mutex_init(&worker->mutex, NULL);
+        pthread_cond_init(&worker->cond, NULL);
+
+        if ((worker->buffers[0] == NULL) || (worker->buffers[1] == NULL) ||
+            (pthread_create(&worker->thread, NULL, WorkerMain, worker) != 0)) {
+            free(worker->buffers[0]);
+            free(worker->buffers[1]);
+            pthread_mutex_destroy(&worker->mutex);
+            pthread_cond_destroy(&worker->cond);
+            retval = -1;
+            break;
+        }
+        started++;
+    }
+
+    for (block = 0; (block < blockCount) && (retval == 0); block++) {
+        worker = &workers[block % threadCount];
+        buffer = (uint32_t)((block / threadCount) % 2u);
+
+        pthread_mutex_lock(&worker->mutex);
+        while (worker->blockIds[buffer] != block) {
+            pthread_cond_wait(&worker->cond, &worker->mutex);
+        }
+        pthread_mutex_unlock(&worker->mutex);
+
+        if (fwrite(worker->buffers[buffer], 1, worker->lens[buffer], fp) != worker->lens[buffer]) {
+            retval = -1;
+        }
+
+        pthread_mutex_lock(&worker->mutex);
+        worker->blockIds[buffer] = UINT64_MAX;
+        pthread_cond_broadcast(&worker->cond);
+        pthread_mutex_unlock(&worker->mutex);
+    }
+
+    for (i = 0; i < started; i++) {
+        worker = &workers[i];
+
+        if (retval != 0) {
+            pthread_mutex_lock(&worker->mutex);
+            worker->abort = true;
+            pthread_cond_broadcast(&worker->cond);
+            pthread_mutex_unlock(&worker->mutex);
+        }
+
+        pthread_join(worker->thread, NULL);
+        free(worker->buffers[0]);
+        free(worker->buffers[1]);
+        pthread_mutex_destroy(&worker->mutex);
+        pthread_cond_destroy(&worker->cond);
+    }
+
+    return retval;
+}
+#endif
+
+/*!
+ * \brief Write all values of a range to a stream, one line per value.
+ * \param range
+ *      The range.
+ * \param threadCount
+ *      The number of formatting threads, between 1 and RANGE_THREADS_MAX.
+ * \param fp
+ *      The output stream.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int WriteRange(const Range *range, uint32_t threadCount, FILE *fp)
+{
+    int retval = 0;
+
+#ifndef _WIN32
+    if (threadCount > 1u) {
+        retval = WriteBlocksThreaded(range, threadCount, fp);
+    } else {
+        retval = WriteBlocks(range, fp);
+    }
+#else
+    /* No threads on this platform. */
+    (void)threadCount;
+    retval = WriteBlocks(range, fp);
+#endif
+
+    if (fflush(fp) != 0) {
+        retval = -1;
+    }
+
+    return retval;
+}
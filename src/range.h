@@ -0,0 +1,87 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RANGE_H__
+#define RANGE_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/* "<20 decimal digits> 0x<16 hexadecimal digits> <64 binary digits>b\n" */
+#define RANGE_LINE_SIZE_MAX     (20u + 1u + 18u + 1u + 65u + 1u)
+#define RANGE_BLOCK_VALUES      16384u /* The number of values formatted at once. */
+#define RANGE_BLOCK_SLACK       64u    /* Scratch space behind the formatted values. */
+#define RANGE_BLOCK_SIZE        (((size_t)RANGE_BLOCK_VALUES * RANGE_LINE_SIZE_MAX) + RANGE_BLOCK_SLACK)
+#define RANGE_THREADS_MAX       64u
+
+/*!
+ * \brief A range of values [start, end) with a step size.
+ */
+typedef struct {
+    uint64_t start; /*!< The first value. */
+    uint64_t end;   /*!< The value behind the last value. */
+    uint64_t step;  /*!< The difference between two consecutive values, at least 1. */
+    uint64_t count; /*!< The number of values in the range. */
+} Range;
+
+/*!
+ * \brief Parse a range argument.
+ * \param string
+ *      The range argument "<start>:<end>[:<step>]", every part as accepted on the command line.
+ * \param separators
+ *      The digit separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param[out] range
+ *      The parsed range.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ParseRange(const char *string, const char *separators, Range *range);
+
+/*!
+ * \brief Format a block of consecutive range values, one line per value.
+ * \details
+ *      Every line holds the value in Decimal, Hexadecimal and Binary, f.e. "10 0xa 1010b". Only the
+ *      first value is formatted by division, the next ones are derived by adding the step to the
+ *      digit strings in place.
+ * \param range
+ *      The range.
+ * \param first
+ *      The index of the first value in the range.
+ * \param count
+ *      The number of values to format, first + count must not exceed range->count.
+ * \param[out] buf
+ *      The output buffer, at least count * RANGE_LINE_SIZE_MAX + RANGE_BLOCK_SLACK bytes.
+ * \returns
+ *      The number of bytes written to buf.
+ */
+size_t FormatRangeBlock(const Range *range, uint64_t first, uint64_t count, char *buf);
+
+/*!
+ * \brief Write all values of a range to a stream, one line per value.
+ * \param range
+ *      The range.
+ * \param threadCount
+ *      The number of formatting threads, between 1 and RANGE_THREADS_MAX.
+ * \param fp
+ *      The output stream.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int WriteRange(const Range *range, uint32_t threadCount, FILE *fp);
+
+#endif /* RANGE_H__ */
@@ -0,0 +1,317 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "numconvert.h"
+#include "shmring.h"
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define IDLE_POLLS_BEFORE_YIELD     1024u
+
+static volatile sig_atomic_t Interrupted = 0;
+
+static void HandleSignal(int signum);
+static void CpuRelax(void);
+static bool IsStopped(const ShmRing *ring);
+static uint64_t Now(void);
+static bool WaitForResponseSlot(const ShmRing *ring, ShmRingResponse *response, uint64_t pos);
+static void InitRing(ShmRing *ring);
+static void ProcessRequest(const ShmRingRequest *request, ShmRingResponse *response);
+
+/*!
+ * \brief Handle a termination signal by requesting the serve loop to stop.
+ * \param signum
+ *      The received signal number.
+ */
+static void HandleSignal(int signum)
+{
+    (void)signum;
+
+    Interrupted = 1;
+}
+
+/*!
+ * \brief Hint the CPU that we are busy-waiting.
+ */
+static void CpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+/*!
+ * \brief Indicate if serving the ring should stop.
+ * \param ring
+ *      The ring that is being served.
+ * \returns
+ *      true if a producer or a signal requested to stop, otherwise false.
+ */
+static bool IsStopped(const ShmRing *ring)
+{
+    return ((Interrupted != 0) || (__atomic_load_n(&ring->stop, __ATOMIC_ACQUIRE) != 0u));
+}
+
+/*!
+ * \brief Return a monotonic timestamp.
+ * \returns
+ *      The timestamp in nanoseconds.
+ */
+static uint64_t Now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+/*!
+ * \brief Wait for the producer of the previous lap to collect its response.
+ * \details
+ *      A response that is not collected within SHMRING_RESPONSE_TIMEOUT_NS is considered abandoned,
+ *      f.e. by a producer that died, and its slot is reclaimed with the same compare-and-swap a
+ *      producer collects it with. A late producer then fails its compare-and-swap and
+ *      ShmRingPoll() reports its ticket with SHMRING_STATUS_RECLAIMED.
+ * \param ring
+ *      The ring that is being served.
+ * \param response
+ *      The response slot.
+ * \param pos
+ *      The position of the request that is about to be processed.
+ * \returns
+ *      true if the slot can be written, false if serving should stop.
+ */
+static bool WaitForResponseSlot(const ShmRing *ring, ShmRingResponse *response, uint64_t pos)
+{
+    uint64_t start = 0;
+    uint64_t expected = 0;
+    uint32_t polls = 0;
+
+    while (__atomic_load_n(&response->sequence, __ATOMIC_ACQUIRE) != pos) {
+        if (IsStopped(ring) == true) {
+            return false;
+        }
+
+        /* Same back-off as the serve loop, the clock is only read when yielding. */
+        polls++;
+        if (polls < IDLE_POLLS_BEFORE_YIELD) {
+            CpuRelax();
+            continue;
+        }
+        polls = 0;
+        (void)sched_yield();
+
+        if (start == 0) {
+            start = Now();
+        } else if ((Now() - start) >= SHMRING_RESPONSE_TIMEOUT_NS) {
+            /* Take the uncollected response of the previous lap, unless it is collected now. */
+            expected = pos - SHMRING_SLOT_COUNT + 1u;
+            (void)__atomic_compare_exchange_n(&response->sequence, &expected, pos, false,
+                                              __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Initialize the ring header and slot sequence numbers.
+ * \details
+ *      The magic is written last so that producers never observe a partially initialized ring.
+ * \param ring
+ *      The ring to initialize.
+ */
+static void InitRing(ShmRing *ring)
+{
+    uint64_t i = 0;
+
+    __atomic_store_n(&ring->magic, 0u, __ATOMIC_RELEASE);
+
+    ring->version = SHMRING_VERSION;
+    ring->slotCount = SHMRING_SLOT_COUNT;
+    ring->stop = 0u;
+    ring->enqueuePos = 0u;
+
+    for (i = 0; i < SHMRING_SLOT_COUNT; i++) {
+        ring->requests[i].sequence = i;
+        ring->responses[i].sequence = i;
+    }
+
+    __atomic_store_n(&ring->magic, SHMRING_MAGIC, __ATOMIC_RELEASE);
+}
+
+/*!
+ * \brief Convert a single request into its response.
+ * \param request
+ *      The request to convert.
+ * \param[out] response
+ *      The response, all fields except the sequence number are written.
+ */
+static void ProcessRequest(const ShmRingRequest *request, ShmRingResponse *response)
+{
+    int retval = 0;
+    uint64_t number = request->number;
+    size_t len = request->len;
+
+    if (len != 0) {
+        /* len comes from shared memory, never let the conversion read beyond token. */
+        if (len >= SHMRING_TOKEN_SIZE) {
+            retval = -1;
+        } else {
+            /* Same conversion as for a command line argument. */
+            retval = ConvertString(request->token, len, &number);
+        }
+    }
+
+    len = 0;
+    if (retval == 0) {
+        len = FormatNumber(number, request->base, response->result);
+        if (len == 0) {
+            /* Unknown output base. */
+            retval = -1;
+        }
+    }
+
+    if (retval != 0) {
+        number = 0;
+        response->result[0] = '\0';
+    }
+
+    response->number = number;
+    response->status = retval;
+    response->len = (uint8_t)len;
+}
+
+/*!
+ * \brief Serve conversion requests from a shared-memory ring until stopped.
+ * \details
+ *      The shared-memory object is created and initialized, and unlinked when serving stops on a
+ *      producer request, SIGINT or SIGTERM. An existing object is never attached to, it may be in
+ *      use by another server and its producers.
+ * \param name
+ *      The POSIX shared-memory object name, f.e. "/numconvert".
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ShmRingServe(const char *name)
+{
+    ShmRing *ring = NULL;
+    ShmRingRequest *request = NULL;
+    ShmRingResponse *response = NULL;
+    uint64_t pos = 0;
+    uint32_t idlePolls = 0;
+    int fd = -1;
+
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        perror("shm_open");
+        return -1;
+    }
+
+    /* The object was created here, remove it again on errors so that the name can be reused. */
+    if (ftruncate(fd, (off_t)sizeof(ShmRing)) != 0) {
+        perror("ftruncate");
+        (void)close(fd);
+        (void)shm_unlink(name);
+        return -1;
+    }
+
+    ring = mmap(NULL, sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (ring == MAP_FAILED) {
+        perror("mmap");
+        (void)shm_unlink(name);
+        return -1;
+    }
+
+    (void)signal(SIGINT, HandleSignal);
+    (void)signal(SIGTERM, HandleSignal);
+
+    InitRing(ring);
+
+    while (IsStopped(ring) == false) {
+        request = &ring->requests[pos & SHMRING_SLOT_MASK];
+        if (__atomic_load_n(&request->sequence, __ATOMIC_ACQUIRE) != (pos + 1)) {
+            /* Nothing published yet, keep polling but give the CPU away once in a while. */
+            idlePolls++;
+            if (idlePolls >= IDLE_POLLS_BEFORE_YIELD) {
+                idlePolls = 0;
+                (void)sched_yield();
+            } else {
+                CpuRelax();
+            }
+            continue;
+        }
+        idlePolls = 0;
+
+        response = &ring->responses[pos & SHMRING_SLOT_MASK];
+        if (WaitForResponseSlot(ring, response, pos) == false) {
+            break;
+        }
+
+        ProcessRequest(request, response);
+
+        __atomic_store_n(&request->sequence, pos + SHMRING_SLOT_COUNT, __ATOMIC_RELEASE);
+        __atomic_store_n(&response->sequence, pos + 1, __ATOMIC_RELEASE);
+        pos++;
+    }
+
+    (void)munmap(ring, sizeof(ShmRing));
+    (void)shm_unlink(name);
+
+    return 0;
+}
+
+#else /* _WIN32 */
+
+/*!
+ * \brief Serve conversion requests from a shared-memory ring until stopped.
+ * \details
+ *      POSIX shared memory is not available on this platform.
+ * \param name
+ *      The POSIX shared-memory object name, f.e. "/numconvert".
+ * \returns
+ *      -1, always.
+ */
+int ShmRingServe(const char *name)
+{
+    (void)name;
+
+    fprintf(stderr, "Shared-memory rings are not supported on this platform\n");
+
+    return -1;
+}
+
+#endif /* _WIN32 */
@@ -0,0 +1,315 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*!
+ * \file
+ * \brief Shared-memory request/response rings for co-located producer processes.
+ * \details
+ *      numconvert --shm <name> creates the POSIX shared-memory object <name>, initializes a
+ *      ShmRing in it and serves requests until a producer sets ShmRing::stop.
+ *
+ *      The request ring is a bounded multi-producer/single-consumer queue: producers claim a
+ *      position with a compare-and-swap on ShmRing::enqueuePos, numconvert is the only consumer.
+ *      A single producer (SPSC) uses the exact same protocol, the compare-and-swap then never
+ *      fails. The response for the request at position p is written to response slot p, so a
+ *      producer polls only its own ticket. Every slot carries a sequence number:
+ *
+ *          request slot:   p = free, p + 1 = request ready
+ *          response slot:  p = free, p + 1 = response ready
+ *
+ *      A slot is freed for the next lap by writing p + SHMRING_SLOT_COUNT. Producers must collect
+ *      every response they requested, an uncollected response blocks the ring once it wraps. After
+ *      SHMRING_RESPONSE_TIMEOUT_NS such a response is considered abandoned and its slot is reused,
+ *      ShmRingPoll() then reports SHMRING_STATUS_RECLAIMED for its ticket.
+ *
+ *      Both sides free a response slot with a compare-and-swap from p + 1 to p + SHMRING_SLOT_COUNT,
+ *      so exactly one of them owns it: the producer after it copied the response, or numconvert
+ *      before it writes the response of the next lap. A producer that loses the compare-and-swap
+ *      raced with a reclaim, its copy may be torn and is discarded.
+ *
+ *      numconvert refuses to serve a name that already exists. An object that is left behind by a
+ *      killed server must be removed with shm_unlink(), f.e. rm /dev/shm/<name> on Linux.
+ *
+ *      This header only depends on the C library and GNU atomic builtins so that producers can
+ *      include it without linking against numconvert.
+ */
+
+#ifndef SHMRING_H__
+#define SHMRING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define SHMRING_MAGIC               0x474e52564e4f434eull /* "NCONVRNG" */
+#define SHMRING_VERSION             1u
+#define SHMRING_SLOT_COUNT          1024u /* Must be a power of 2. */
+#define SHMRING_SLOT_MASK           (SHMRING_SLOT_COUNT - 1u)
+#define SHMRING_CACHE_LINE_SIZE     64u
+#define SHMRING_TOKEN_SIZE          66u /* Longest numeric string (65) + string terminator. */
+#define SHMRING_RESULT_SIZE         80u /* Longest formatted result (Binary) + string terminator. */
+#define SHMRING_RESPONSE_TIMEOUT_NS 1000000000ull /* Until an uncollected response is reclaimed. */
+#define SHMRING_STATUS_RECLAIMED    (-2) /* The response was not collected in time. */
+
+/*!
+ * \brief A conversion request.
+ * \details
+ *      When len is 0 the request converts number, otherwise it parses the first len characters of
+ *      token the same way the numconvert command line argument is parsed.
+ */
+typedef struct {
+    uint64_t sequence;                  /*!< Slot sequence number, see the file description. */
+    uint64_t number;                    /*!< The number to convert when len is 0. */
+    uint8_t len;                        /*!< The token length, 0 to convert number instead. */
+    char base;                          /*!< The output base, 'b', 'd' or 'h'. */
+    char token[SHMRING_TOKEN_SIZE];     /*!< The numeric string to convert when len is not 0. */
+} __attribute__((aligned(SHMRING_CACHE_LINE_SIZE))) ShmRingRequest;
+
+/*!
+ * \brief A conversion response.
+ */
+typedef struct {
+    uint64_t sequence;                  /*!< Slot sequence number, see the file description. */
+    uint64_t number;                    /*!< The parsed number. */
+    int32_t status;                     /*!< 0 in case of success, -1 for an invalid request or
+                                             SHMRING_STATUS_RECLAIMED. */
+    uint8_t len;                        /*!< The length of result (excluding the terminator). */
+    char result[SHMRING_RESULT_SIZE];   /*!< The formatted number, empty in case of an error. */
+} __attribute__((aligned(SHMRING_CACHE_LINE_SIZE))) ShmRingResponse;
+
+/*!
+ * \brief The shared-memory object layout.
+ */
+typedef struct {
+    uint64_t magic;                     /*!< SHMRING_MAGIC once the rings are initialized. */
+    uint32_t version;                   /*!< SHMRING_VERSION. */
+    uint32_t slotCount;                 /*!< SHMRING_SLOT_COUNT. */
+    uint32_t stop;                      /*!< Set to non-zero to make numconvert exit. */
+    uint64_t enqueuePos __attribute__((aligned(SHMRING_CACHE_LINE_SIZE)));
+    ShmRingRequest requests[SHMRING_SLOT_COUNT];
+    ShmRingResponse responses[SHMRING_SLOT_COUNT];
+} ShmRing;
+
+/*!
+ * \brief Claim a request slot and return it for filling in.
+ * \param ring
+ *      The attached ring.
+ * \param[out] ticket
+ *      The claimed position, to be passed to ShmRingPublish() and ShmRingPoll().
+ * \returns
+ *      The claimed request slot or NULL when the ring is full.
+ */
+static inline ShmRingRequest* ShmRingClaim(ShmRing *ring, uint64_t *ticket)
+{
+    ShmRingRequest *request = NULL;
+    uint64_t pos = __atomic_load_n(&ring->enqueuePos, __ATOMIC_RELAXED);
+    uint64_t sequence = 0;
+    int64_t diff = 0;
+
+    while (1) {
+        request = &ring->requests[pos & SHMRING_SLOT_MASK];
+        sequence = __atomic_load_n(&request->sequence, __ATOMIC_ACQUIRE);
+        diff = (int64_t)(sequence - pos);
+
+        if (diff == 0) {
+            /* The slot is free for this lap, try to claim it (pos is updated on failure). */
+            if (__atomic_compare_exchange_n(&ring->enqueuePos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED) == true) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* The consumer is a full lap behind. */
+            return NULL;
+        } else {
+            /* Another producer claimed this position. */
+            pos = __atomic_load_n(&ring->enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    *ticket = pos;
+
+    return request;
+}
+
+/*!
+ * \brief Publish a filled in request slot to numconvert.
+ * \param request
+ *      The request slot as returned by ShmRingClaim().
+ * \param ticket
+ *      The ticket as returned by ShmRingClaim().
+ */
+static inline void ShmRingPublish(ShmRingRequest *request, uint64_t ticket)
+{
+    __atomic_store_n(&request->sequence, ticket + 1, __ATOMIC_RELEASE);
+}
+
+/*!
+ * \brief Submit a numeric string for conversion.
+ * \param ring
+ *      The attached ring.
+ * \param token
+ *      The numeric string, f.e. "0x12" or "1010b".
+ * \param len
+ *      The length of token, between 1 and SHMRING_TOKEN_SIZE - 1.
+ * \param base
+ *      The output base, 'b', 'd' or 'h'.
+ * \param[out] ticket
+ *      The ticket to poll the response with.
+ * \returns
+ *      0 in case of successful completion or -1 when the token is too long or the ring is full.
+ */
+static inline int ShmRingSubmitToken(ShmRing *ring, const char *token, size_t len, char base,
+                                     uint64_t *ticket)
+{
+    ShmRingRequest *request = NULL;
+
+    if ((len == 0) || (len >= SHMRING_TOKEN_SIZE)) {
+        return -1;
+    }
+
+    request = ShmRingClaim(ring, ticket);
+    if (request == NULL) {
+        return -1;
+    }
+
+    request->len = (uint8_t)len;
+    request->base = base;
+    memcpy(request->token, token, len);
+    ShmRingPublish(request, *ticket);
+
+    return 0;
+}
+
+/*!
+ * \brief Submit a number for conversion.
+ * \param ring
+ *      The attached ring.
+ * \param number
+ *      The number to convert.
+ * \param base
+ *      The output base, 'b', 'd' or 'h'.
+ * \param[out] ticket
+ *      The ticket to poll the response with.
+ * \returns
+ *      0 in case of successful completion or -1 when the ring is full.
+ */
+static inline int ShmRingSubmitNumber(ShmRing *ring, uint64_t number, char base, uint64_t *ticket)
+{
+    ShmRingRequest *request = NULL;
+
+    request = ShmRingClaim(ring, ticket);
+    if (request == NULL) {
+        return -1;
+    }
+
+    request->len = 0;
+    request->base = base;
+    request->number = number;
+    ShmRingPublish(request, *ticket);
+
+    return 0;
+}
+
+/*!
+ * \brief Collect the response of a submitted request, when available.
+ * \details
+ *      The response slot is released for reuse once it has been copied. A response that was not
+ *      collected within SHMRING_RESPONSE_TIMEOUT_NS is reported as available with status
+ *      SHMRING_STATUS_RECLAIMED, its result is lost.
+ * \param ring
+ *      The attached ring.
+ * \param ticket
+ *      The ticket as returned on submission.
+ * \param[out] response
+ *      A copy of the response.
+ * \returns
+ *      true if the response was available, otherwise false.
+ */
+static inline bool ShmRingPoll(ShmRing *ring, uint64_t ticket, ShmRingResponse *response)
+{
+    ShmRingResponse *slot = &ring->responses[ticket & SHMRING_SLOT_MASK];
+    uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    uint64_t expected = ticket + 1;
+    uint8_t len = 0;
+
+    if (sequence == expected) {
+        /* Copy all of result, len may be torn when numconvert reclaims the slot meanwhile. */
+        response->number = slot->number;
+        response->status = slot->status;
+        len = slot->len;
+        memcpy(response->result, slot->result, sizeof(response->result));
+
+        /* The release ordering keeps the copy before the slot is handed back. */
+        if (__atomic_compare_exchange_n(&slot->sequence, &expected, ticket + SHMRING_SLOT_COUNT,
+                                        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) == true) {
+            response->len = (len < SHMRING_RESULT_SIZE) ? len : 0u;
+            response->result[response->len] = '\0';
+            return true;
+        }
+        sequence = expected;
+    }
+
+    if ((int64_t)(sequence - (ticket + 1)) > 0) {
+        /* The server reclaimed the slot for a later lap. */
+        response->number = 0;
+        response->status = SHMRING_STATUS_RECLAIMED;
+        response->len = 0;
+        response->result[0] = '\0';
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ * \brief Request numconvert to stop serving the ring.
+ * \param ring
+ *      The attached ring.
+ */
+static inline void ShmRingStop(ShmRing *ring)
+{
+    __atomic_store_n(&ring->stop, 1u, __ATOMIC_RELEASE);
+}
+
+/*!
+ * \brief Indicate if numconvert has initialized the ring.
+ * \details
+ *      Producers map the shared-memory object with shm_open() and mmap() of sizeof(ShmRing)
+ *      bytes and must wait for this to return true before submitting requests.
+ * \param ring
+ *      The mapped ring.
+ * \returns
+ *      true if the ring is ready for use, otherwise false.
+ */
+static inline bool ShmRingIsReady(const ShmRing *ring)
+{
+    return ((__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) == SHMRING_MAGIC) &&
+            (ring->version == SHMRING_VERSION) &&
+            (ring->slotCount == SHMRING_SLOT_COUNT));
+}
+
+/*!
+ * \brief Serve conversion requests from a shared-memory ring until stopped.
+ * \param name
+ *      The POSIX shared-memory object name, f.e. "/numconvert".
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ShmRingServe(const char *name);
+
+#endif /* SHMRING_H__ */
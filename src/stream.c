@@ -0,0 +1,442 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stream.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define NIBBLE_BITS         4u
+#define STREAM_BLOCK_SIZE   16u /* The number of characters converted at once with SSE2. */
+#define STREAM_OUTPUT_SIZE  ((STREAM_CHUNK_SIZE * NIBBLE_BITS) + 1u) /* Expanded chunk + '\n'. */
+
+#define CLASS_SKIP          0x10u /* Whitespace and digit separators. */
+#define CLASS_INVALID       0x20u /* Any other non-digit character. */
+
+/*!
+ * \brief The conversion state that is carried from one chunk to the next.
+ */
+typedef struct {
+    uint8_t classes[256];           /*!< The digit value or CLASS_* of every input character. */
+    uint8_t pairs[256][2];          /*!< The 2 Hexadecimal digits of every 8 Binary digit mask. */
+    uint32_t nibble;                /*!< The Binary digits of the incomplete nibble. */
+    uint32_t nibbleBits;            /*!< The number of digits in nibble, including padding. */
+    uint64_t digitCount;            /*!< The number of converted input digits. */
+} Stream;
+
+static const char HexChars[] = "0123456789abcdef";
+
+/* The Binary digits of every nibble value. */
+static const char NibbleDigits[16][NIBBLE_BITS] = {
+    {'0','0','0','0'}, {'0','0','0','1'}, {'0','0','1','0'}, {'0','0','1','1'},
+    {'0','1','0','0'}, {'0','1','0','1'}, {'0','1','1','0'}, {'0','1','1','1'},
+    {'1','0','0','0'}, {'1','0','0','1'}, {'1','0','1','0'}, {'1','0','1','1'},
+    {'1','1','0','0'}, {'1','1','0','1'}, {'1','1','1','0'}, {'1','1','1','1'}
+};
+
+static void StreamInit(Stream *stream, char base, const char *separators);
+static int CountDigits(const Stream *stream, FILE *in, uint64_t *count);
+static size_t ExpandChunk(Stream *stream, const char *input, size_t len, char *output, int *retval);
+static size_t CompressChunk(Stream *stream, const char *input, size_t len, char *output,
+                            int *retval);
+
+/*!
+ * \brief Initialize the character classes and lookup tables of a stream.
+ * \param[out] stream
+ *      The stream to initialize.
+ * \param base
+ *      The input base, 'b' or 'h'.
+ * \param separators
+ *      The separator characters or NULL for none.
+ */
+static void StreamInit(Stream *stream, char base, const char *separators)
+{
+    uint32_t c = 0;
+    uint32_t mask = 0;
+    uint32_t first = 0;
+    uint32_t second = 0;
+    uint32_t i = 0;
+
+    memset(stream, 0, sizeof(*stream));
+    memset(stream->classes, CLASS_INVALID, sizeof(stream->classes));
+
+    stream->classes['0'] = 0;
+    stream->classes['1'] = 1;
+    if (base == 'h') {
+        for (c = '2'; c <= '9'; c++) {
+            stream->classes[c] = (uint8_t)(c - '0');
+        }
+        for (c = 'a'; c <= 'f'; c++) {
+            stream->classes[c] = (uint8_t)(c - 'a' + 10u);
+            stream->classes[c - 'a' + 'A'] = (uint8_t)(c - 'a' + 10u);
+        }
+    }
+
+    stream->classes[' '] = CLASS_SKIP;
+    stream->classes['\t'] = CLASS_SKIP;
+    stream->classes['\r'] = CLASS_SKIP;
+    stream->classes['\n'] = CLASS_SKIP;
+    if (separators != NULL) {
+        for (; *separators != '\0'; separators++) {
+            stream->classes[(uint8_t)*separators] = CLASS_SKIP;
+        }
+    }
+
+    /* Bit i of a mask is Binary digit i, the first digit is the most significant one. */
+    for (mask = 0; mask < 256u; mask++) {
+        first = 0;
+        second = 0;
+        for (i = 0; i < NIBBLE_BITS; i++) {
+            first = (first << 1) | ((mask >> i) & 1u);
+            second = (second << 1) | ((mask >> (i + NIBBLE_BITS)) & 1u);
+        }
+        stream->pairs[mask][0] = (uint8_t)HexChars[first];
+        stream->pairs[mask][1] = (uint8_t)HexChars[second];
+    }
+}
+
+/*!
+ * \brief Count the digits in a seekable input stream and rewind it.
+ * \details
+ *      Only used for Binary input. With SSE2, the digits in a block of STREAM_BLOCK_SIZE characters
+ *      are counted at once from the compare masks.
+ * \param stream
+ *      The initialized stream.
+ * \param in
+ *      The input stream.
+ * \param[out] count
+ *      The number of digits.
+ * \returns
+ *      0 in case of successful completion, 1 if the input is not seekable or any other value in
+ *      case of an error.
+ */
+static int CountDigits(const Stream *stream, FILE *in, uint64_t *count)
+{
+    char *input = NULL;
+    long start = 0;
+    size_t len = 0;
+    size_t i = 0;
+    int retval = 0;
+#if defined(__SSE2__)
+    __m128i block;
+#endif
+
+    start = ftell(in);
+    if (start < 0) {
+        return 1;
+    }
+
+    input = malloc(STREAM_CHUNK_SIZE);
+    if (input == NULL) {
+        return -1;
+    }
+
+    *count = 0;
+    while ((len = fread(input, 1, STREAM_CHUNK_SIZE, in)) > 0) {
+        i = 0;
+#if defined(__SSE2__)
+        for (; (i + STREAM_BLOCK_SIZE) <= len; i += STREAM_BLOCK_SIZE) {
+            block = _mm_loadu_si128((const __m128i *)&input[i]);
+            *count += (uint64_t)__builtin_popcount((uint32_t)_mm_movemask_epi8(
+                          _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('0')),
+                                       _mm_cmpeq_epi8(block, _mm_set1_epi8('1')))));
+        }
+#endif
+        for (; i < len; i++) {
+            *count += (stream->classes[(uint8_t)input[i]] < CLASS_SKIP) ? 1u : 0u;
+        }
+    }
+
+    if ((ferror(in) != 0) || (fseek(in, start, SEEK_SET) != 0)) {
+        retval = -1;
+    }
+
+    free(input);
+
+    return retval;
+}
+
+/*!
+ * \brief Expand a chunk of Hexadecimal digits to Binary digits.
+ * \details
+ *      With SSE2, blocks of STREAM_BLOCK_SIZE digits are converted to their values, every value is
+ *      broadcast to 4 bytes by unpacking and compared against the bit masks 8, 4, 2 and 1. A block
+ *      that holds any other character is handled per character.
+ * \param stream
+ *      The stream.
+ * \param input
+ *      The input characters.
+ * \param len
+ *      The number of input characters.
+ * \param[out] output
+ *      The Binary digits, at least len * 4 bytes.
+ * \param[out] retval
+ *      Set to -1 in case of an invalid character, otherwise left unchanged.
+ * \returns
+ *      The number of Binary digits written to output.
+ */
+static size_t ExpandChunk(Stream *stream, const char *input, size_t len, char *output, int *retval)
+{
+    size_t outputLen = 0;
+    size_t i = 0;
+    size_t end = 0;
+    uint8_t value = 0;
+#if defined(__SSE2__)
+    const __m128i bits = _mm_set1_epi32(0x01020408);
+    const __m128i zeros = _mm_set1_epi8('0');
+    __m128i block;
+    __m128i lower;
+    __m128i isDigit;
+    __m128i isLetter;
+    __m128i values;
+    __m128i pairs;
+    __m128i quads[4];
+    size_t j = 0;
+#endif
+
+    while (i < len) {
+#if defined(__SSE2__)
+        if ((i + STREAM_BLOCK_SIZE) <= len) {
+            block = _mm_loadu_si128((const __m128i *)&input[i]);
+
+            /* Signed compares, characters >= 0x80 are negative and never a digit. */
+            isDigit = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1)),
+                                    _mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1)));
+            lower = _mm_or_si128(block, _mm_set1_epi8(0x20));
+            isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                     _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+            if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) == 0xffff) {
+                /* '0' - '9' are 0x30 - 0x39, 'a' - 'f' and 'A' - 'F' are 0x?1 - 0x?6 + 9. */
+                values = _mm_add_epi8(_mm_and_si128(block, _mm_set1_epi8(0x0f)),
+                                      _mm_and_si128(isLetter, _mm_set1_epi8(9)));
+
+                pairs = _mm_unpacklo_epi8(values, values);
+                quads[0] = _mm_unpacklo_epi16(pairs, pairs);
+                quads[1] = _mm_unpackhi_epi16(pairs, pairs);
+                pairs = _mm_unpackhi_epi8(values, values);
+                quads[2] = _mm_unpacklo_epi16(pairs, pairs);
+                quads[3] = _mm_unpackhi_epi16(pairs, pairs);
+
+                for (j = 0; j < 4u; j++) {
+                    /* '0' - (-1) is '1'. */
+                    quads[j] = _mm_sub_epi8(zeros, _mm_cmpeq_epi8(_mm_and_si128(quads[j], bits),
+                                                                  bits));
+                    _mm_storeu_si128((__m128i *)&output[outputLen], quads[j]);
+                    outputLen += STREAM_BLOCK_SIZE;
+                }
+
+                i += STREAM_BLOCK_SIZE;
+                continue;
+            }
+        }
+#endif
+
+        end = i + STREAM_BLOCK_SIZE;
+        if (end > len) {
+            end = len;
+        }
+
+        for (; i < end; i++) {
+            value = stream->classes[(uint8_t)input[i]];
+            if (value < CLASS_SKIP) {
+                memcpy(&output[outputLen], NibbleDigits[value], NIBBLE_BITS);
+                outputLen += NIBBLE_BITS;
+            } else if (value == CLASS_INVALID) {
+                *retval = -1;
+                return outputLen;
+            }
+        }
+    }
+
+    stream->digitCount += outputLen / NIBBLE_BITS;
+
+    return outputLen;
+}
+
+/*!
+ * \brief Compress a chunk of Binary digits to Hexadecimal digits.
+ * \details
+ *      With SSE2, blocks of STREAM_BLOCK_SIZE digits are compared against '1' and the byte mask
+ *      selects 2 Hexadecimal digits per 8 Binary digits from a table. This requires the block to
+ *      start at a nibble boundary, other blocks are handled per character.
+ * \param stream
+ *      The stream, holding the incomplete nibble of the previous chunk.
+ * \param input
+ *      The input characters.
+ * \param len
+ *      The number of input characters.
+ * \param[out] output
+ *      The Hexadecimal digits, at least len / 4 + 1 bytes.
+ * \param[out] retval
+ *      Set to -1 in case of an invalid character, otherwise left unchanged.
+ * \returns
+ *      The number of Hexadecimal digits written to output.
+ */
+static size_t CompressChunk(Stream *stream, const char *input, size_t len, char *output,
+                            int *retval)
+{
+    size_t outputLen = 0;
+    size_t i = 0;
+    size_t end = 0;
+    uint8_t value = 0;
+#if defined(__SSE2__)
+    __m128i block;
+    __m128i isOne;
+    __m128i isZero;
+    uint32_t mask = 0;
+#endif
+
+    while (i < len) {
+#if defined(__SSE2__)
+        if (((i + STREAM_BLOCK_SIZE) <= len) && (stream->nibbleBits == 0)) {
+            block = _mm_loadu_si128((const __m128i *)&input[i]);
+            isOne = _mm_cmpeq_epi8(block, _mm_set1_epi8('1'));
+            isZero = _mm_cmpeq_epi8(block, _mm_set1_epi8('0'));
+
+            if (_mm_movemask_epi8(_mm_or_si128(isOne, isZero)) == 0xffff) {
+                mask = (uint32_t)_mm_movemask_epi8(isOne);
+                memcpy(&output[outputLen], stream->pairs[mask & 0xffu], 2);
+                memcpy(&output[outputLen + 2u], stream->pairs[mask >> 8], 2);
+                outputLen += STREAM_BLOCK_SIZE / NIBBLE_BITS;
+                stream->digitCount += STREAM_BLOCK_SIZE;
+
+                i += STREAM_BLOCK_SIZE;
+                continue;
+            }
+        }
+#endif
+
+        end = i + STREAM_BLOCK_SIZE;
+        if (end > len) {
+            end = len;
+        }
+
+        for (; i < end; i++) {
+            value = stream->classes[(uint8_t)input[i]];
+            if (value < CLASS_SKIP) {
+                stream->nibble = (stream->nibble << 1) | value;
+                stream->nibbleBits++;
+                stream->digitCount++;
+                if (stream->nibbleBits == NIBBLE_BITS) {
+                    output[outputLen++] = HexChars[stream->nibble];
+                    stream->nibble = 0;
+                    stream->nibbleBits = 0;
+                }
+            } else if (value == CLASS_INVALID) {
+                *retval = -1;
+                return outputLen;
+            }
+        }
+    }
+
+    return outputLen;
+}
+
+/*!
+ * \brief Convert a stream of Binary digits to Hexadecimal digits or vice versa.
+ * \details
+ *      Binary digits are grouped per nibble from the least significant digit. When the input is
+ *      seekable, f.e. a redirected file, the digits are counted first and the most significant
+ *      group is zero-padded. Otherwise the number of Binary digits must be a multiple of 4, the
+ *      number of digits left over is reported on stderr.
+ * \param base
+ *      The input base, 'b' for Binary to Hexadecimal or 'h' for Hexadecimal to Binary.
+ * \param separators
+ *      The separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param in
+ *      The input stream.
+ * \param out
+ *      The output stream.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error. The output is
+ *      incomplete in case of an error.
+ */
+int ConvertStream(char base, const char *separators, FILE *in, FILE *out)
+{
+    Stream *stream = NULL;
+    char *input = NULL;
+    char *output = NULL;
+    uint64_t count = 0;
+    size_t len = 0;
+    size_t outputLen = 0;
+    bool isPadded = true;
+    int retval = 0;
+
+    if ((base != 'b') && (base != 'h')) {
+        return -1;
+    }
+
+    stream = malloc(sizeof(*stream));
+    input = malloc(STREAM_CHUNK_SIZE);
+    output = malloc(STREAM_OUTPUT_SIZE);
+    if ((stream == NULL) || (input == NULL) || (output == NULL)) {
+        retval = -1;
+    }
+
+    if (retval == 0) {
+        StreamInit(stream, base, separators);
+
+        if (base == 'b') {
+            retval = CountDigits(stream, in, &count);
+            if (retval == 1) {
+                /* Not seekable, the number of digits must be a multiple of 4. */
+                isPadded = false;
+                retval = 0;
+            } else if (retval == 0) {
+                /* Pad the most significant nibble with leading zeros. */
+                stream->nibbleBits = (NIBBLE_BITS - (uint32_t)(count % NIBBLE_BITS)) % NIBBLE_BITS;
+            }
+        }
+    }
+
+    while ((retval == 0) && ((len = fread(input, 1, STREAM_CHUNK_SIZE, in)) > 0)) {
+        if (base == 'h') {
+            outputLen = ExpandChunk(stream, input, len, output, &retval);
+        } else {
+            outputLen = CompressChunk(stream, input, len, output, &retval);
+        }
+
+        if ((retval == 0) && (fwrite(output, 1, outputLen, out) != outputLen)) {
+            retval = -1;
+        }
+    }
+
+    if ((retval == 0) && (isPadded == false) && (stream->nibbleBits != 0)) {
+        fprintf(stderr, "bin2hex: %u Binary digit(s) left over, the number of digits must be a "
+                "multiple of 4 for input that is not seekable\n", (unsigned int)stream->nibbleBits);
+        retval = -1;
+    }
+
+    if ((retval == 0) &&
+        ((ferror(in) != 0) || (stream->digitCount == 0) || (stream->nibbleBits != 0) ||
+         (fputc('\n', out) == EOF))) {
+        retval = -1;
+    }
+
+    free(stream);
+    free(input);
+    free(output);
+
+    return retval;
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*!
+ * \file
+ * \brief Unbounded streaming conversion between Binary and Hexadecimal digits.
+ * \details
+ *      Every Hexadecimal digit maps onto exactly 4 Binary digits, so a digit stream of any length
+ *      can be converted chunk by chunk without ever parsing the whole number. The input is raw
+ *      digits without prefix or postfix, whitespace and the digit separators are ignored. The
+ *      output is a single line of lowercase digits, leading zeros included.
+ */
+
+#ifndef STREAM_H__
+#define STREAM_H__
+
+#include <stdio.h>
+
+#define STREAM_CHUNK_SIZE       65536u /* The number of input characters read at once. */
+
+/*!
+ * \brief Convert a stream of Binary digits to Hexadecimal digits or vice versa.
+ * \details
+ *      Binary digits are grouped per nibble from the least significant digit. When the input is
+ *      seekable, f.e. a redirected file, the digits are counted first and the most significant
+ *      group is zero-padded. Otherwise the number of Binary digits must be a multiple of 4, the
+ *      number of digits left over is reported on stderr.
+ * \param base
+ *      The input base, 'b' for Binary to Hexadecimal or 'h' for Hexadecimal to Binary.
+ * \param separators
+ *      The separator characters as accepted by CheckSeparators(), or NULL for none.
+ * \param in
+ *      The input stream.
+ * \param out
+ *      The output stream.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error. The output is
+ *      incomplete in case of an error.
+ */
+int ConvertStream(char base, const char *separators, FILE *in, FILE *out);
+
+#endif /* STREAM_H__ */
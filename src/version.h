@@ -18,29 +18,15 @@
 #ifndef VERSION_H__
 #define VERSION_H__
 
-#include <stdio.h>
+#define VERSION_MAJOR       1
+#define VERSION_MINOR       0
+#define VERSION_PATCH       5
 
-#define VERSION_MAJOR       1u
-#define VERSION_MINOR       0u
-#define VERSION_PATCH       5u
+#define VERSION_STRINGIFY(x)    #x
+#define VERSION_TO_STRING(x)    VERSION_STRINGIFY(x)
 
-#define VERSION_STRING_LEN  12u /* mjr.mnr.pat + \0 */
-
-/*!
- * \brief Return the current version.
- * \details
- *      Semantic versioning 2.0.0 as per <https://semver.org/>.
- *      Each part of the version number (major, minor, patch) shall be limited to a value no more
- *      than 255.
- * \returns A char pointer to the version string.
- */
-static inline const char* GetVersionString(void)
-{
-    static char version[VERSION_STRING_LEN];
-
-    (void)sprintf(version, "%u.%u.%u", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
-
-    return version;
-}
+/* The version string as a string literal, f.e. "1.0.5" (semantic versioning 2.0.0). */
+#define VERSION_STRING      VERSION_TO_STRING(VERSION_MAJOR) "." VERSION_TO_STRING(VERSION_MINOR) \
+                            "." VERSION_TO_STRING(VERSION_PATCH)
 
 #endif /* VERSION_H__ */
@@ -1,235 +1,1649 @@
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "numconvert.h"
+#include "range.h"
+#include "stream.h"
+#include "layout.h"
 
 #define STRING_LENGTH_MAX           100u /* 99 + string terminator */
-#define DECIMAL_STRING_LEN_MAX      3u
-
-#define STDOUT_STRING_LENGTH_MAX    512u
+#define ARGUMENT_LEN_MAX            65u  /* Longest accepted argument, "<64 binary digits>b". */
+#define STDOUT_FILE_SIZE_MAX        4096u
+#define COMMAND_ARGUMENTS_MAX       8u
+#define COMMAND_OUTPUT_SIZE_MAX     4096u
+#define RANDOM_CASE_COUNT_DEFAULT   10000000u
+#define FAILURE_REPORT_MAX          10u
+#define SEPARATORS                  "_', " /* The separators used for the random cases. */
+#define RANGE_CASE_COUNT            2000u
+#define RANGE_CASE_VALUES_MAX       1000u
+#define LAYOUT_CASE_COUNT           2000u
+#define STREAM_CASE_COUNT           40u
+#define STREAM_CASE_DIGITS_MAX      100000u /* Hexadecimal digits, more than 1 chunk in Binary. */
+#define STREAM_BUFFER_SIZE          ((STREAM_CASE_DIGITS_MAX * 8u) + 2u) /* Digits + whitespace. */
 
 #define RETURN_VALUE_FAILURE_CODE   100u
 #define STDIO_OUTPUT_FAILURE_CODE   200u
+#define CONVERSION_FAILURE_CODE     201u
 
-/* UINT64_MAX equivalent string. */
-const char *DecimalStringValueMax = "255";
+/*!
+ * \brief A golden-file test case, the expected console output is stored in file.
+ */
+typedef struct {
+    const char *name;   /*!< The test name. */
+    const char *input;  /*!< The command line argument. */
+    int retval;         /*!< The expected exit status, between 0 and 255. */
+    const char *file;   /*!< The file that contains the expected stdout output. */
+} GoldenCase;
 
-static bool IsDecimalChar(char c);
-static bool IsDecimal(const char *string, size_t len);
+/*!
+ * \brief A table-driven test case.
+ */
+typedef struct {
+    const char *input;  /*!< The numeric string. */
+    bool isValid;       /*!< true if numconvert should accept the numeric string. */
+    uint64_t number;    /*!< The number represented by input when isValid is true. */
+} TableCase;
 
 /*!
- * \brief Indicate if a character represents a valid Decimal character.
- * \param c
- *      The character to verify.
+ * \brief An end-to-end test case, the numconvert executable is run with arguments and stdin.
+ */
+typedef struct {
+    const char *name;                           /*!< The test name. */
+    const char *args[COMMAND_ARGUMENTS_MAX];    /*!< The command line arguments, NULL terminated. */
+    const char *input;                          /*!< The stdin input, NULL for none. */
+    int retval;                                 /*!< The expected exit status. */
+    const char *file;                           /*!< The file with the expected stdout, or NULL. */
+    const char *output;                         /*!< The expected stdout when file is NULL. */
+    const char *errors;                         /*!< The expected stderr, or NULL to ignore it. */
+} CommandCase;
+
+static const GoldenCase GoldenCases[] = {
+    /* Decimal boundary tests. */
+    { "1", "0", 0, "stdout/1.txt" },
+    { "2", "18446744073709551615", 0, "stdout/2.txt" },
+    { "3", "-1", 255, "stdout/3.txt" },
+    { "4", "18446744073709551616", 255, "stdout/4.txt" },
+    /* Binary boundary tests. */
+    { "5", "0b", 0, "stdout/5.txt" },
+    { "6", "1111111111111111111111111111111111111111111111111111111111111111b", 0, "stdout/6.txt" },
+    { "7", "11111111111111111111111111111111111111111111111111111111111111111b", 255, "stdout/7.txt" },
+    /* Hexadecimal boundary tests. */
+    { "8", "0x0", 0, "stdout/8.txt" },
+    { "9", "0h", 0, "stdout/9.txt" },
+    { "10", "0xffffffffffffffff", 0, "stdout/10.txt" },
+    { "11", "ffffffffffffffffh", 0, "stdout/11.txt" },
+    { "12", "0x1ffffffffffffffff", 255, "stdout/12.txt" },
+    { "13", "1ffffffffffffffffh", 255, "stdout/13.txt" },
+    /* ECP tests. */
+    { "14", "9223372036854775808", 0, "stdout/14.txt" },
+    { "15", "1000000000000000000000000000000000000000000000000000000000000000b", 0, "stdout/15.txt" },
+    { "16", "0x8000000000000000", 0, "stdout/16.txt" },
+    /* Upper to lower case conversion tests. */
+    { "17", "0xaBcDe", 0, "stdout/17.txt" },
+    { "18", "0XAbCdE", 0, "stdout/18.txt" },
+    { "19", "aBcDeh", 0, "stdout/19.txt" },
+    { "20", "AbCdEH", 0, "stdout/20.txt" },
+    { "21", "1001B", 0, "stdout/21.txt" },
+    /* 0 input tests. */
+    { "22", "0", 0, "stdout/22.txt" },
+    { "23", "0x0", 0, "stdout/23.txt" },
+    { "24", "0h", 0, "stdout/24.txt" },
+    { "25", "0b", 0, "stdout/25.txt" },
+    /* Invalid input tests. */
+    { "26", "3/", 255, "stdout/26.txt" },
+    { "27", "0x3/", 255, "stdout/27.txt" },
+    { "28", "1/b", 255, "stdout/28.txt" },
+    { "29", "b", 255, "stdout/29.txt" },
+    { "30", "0x", 255, "stdout/30.txt" },
+    { "31", "h", 255, "stdout/31.txt" },
+    { "32", "", 255, "stdout/32.txt" },
+    { "33", "0z", 255, "stdout/33.txt" },
+    { "34", " ", 255, "stdout/34.txt" },
+    { "35", "\"\"", 255, "stdout/35.txt" },
+    { "36", "123456789012345678901", 255, "stdout/36.txt" },
+    { "37", "0xg", 255, "stdout/37.txt" },
+    /* Additional coverage tests. */
+    { "38", "17446744073709551616", 0, "stdout/38.txt" },
+};
+
+static const CommandCase CommandCases[] = {
+    /* Argument count and option errors. */
+    { "no argument", { NULL }, NULL, 255, "stdout/32.txt", NULL },
+    { "2 arguments", { "1", "2", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    { "unknown option", { "--foo", "1", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    { "option without value", { "--separators", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    { "shm without name", { "--shm", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    /* Digit separators. */
+    { "separators", { "--separators", "_", "1_0_0_1B", NULL }, NULL, 0, "stdout/21.txt", NULL },
+    { "separators set", { "--separators", "_'", "0xa_B'cDe", NULL }, NULL, 0, "stdout/17.txt",
+      NULL },
+    { "invalid separators", { "--separators", "a", "1", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    { "sign separators", { "--separators", "-", "1-0", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    { "separator at postfix", { "--separators", " ", "10 b", NULL }, NULL, 255, "stdout/32.txt",
+      NULL },
+    { "separator not set", { "1_0", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    /* Range generation. */
+    { "range", { "--range", "0x8:20:4", NULL }, NULL, 0, NULL,
+      "8 0x8 1000b\n12 0xc 1100b\n16 0x10 10000b\n" },
+    { "range threads", { "--threads", "3", "--range", "0:4", NULL }, NULL, 0, NULL,
+      "0 0x0 0b\n1 0x1 1b\n2 0x2 10b\n3 0x3 11b\n" },
+    { "range separators", { "--separators", "_", "--range", "1_0:1_1", NULL }, NULL, 0, NULL,
+      "10 0xa 1010b\n" },
+    { "empty range", { "--range", "5:5", NULL }, NULL, 0, NULL, "" },
+    { "invalid range", { "--range", "5:4", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    { "range with value", { "--range", "0:2", "5", NULL }, NULL, 255, "stdout/32.txt", NULL },
+    { "invalid threads", { "--threads", "0", "--range", "0:2", NULL }, NULL, 255,
+      "stdout/32.txt", NULL },
+    { "threads without range", { "--threads", "2", "0x10", NULL }, NULL, 255, "stdout/32.txt",
+      NULL },
+    { "threads and stream", { "--threads", "2", "--stream", "hex2bin", NULL }, "a\n", 255,
+      "stdout/32.txt", NULL },
+    { "threads and layout", { "--threads", "2", "--layout", "layout/ctrl.txt", "0x1", NULL },
+      NULL, 255, "stdout/32.txt", NULL },
+    /* Streaming conversion. */
+    { "hex2bin", { "--stream", "hex2bin", NULL }, "dE aD\n", 0, NULL, "1101111010101101\n" },
+    { "bin2hex", { "--separators", "_", "--stream", "bin2hex", NULL }, "1100_1010\n", 0, NULL,
+      "ca\n" },
+    { "invalid stream", { "--stream", "hex2bin", NULL }, "0x12\n", 255, NULL, NULL },
+    { "unaligned bin2hex pipe", { "--stream", "bin2hex", NULL }, "101101\n", 255, NULL, NULL },
+    { "unknown stream", { "--stream", "bin2dec", NULL }, "1\n", 255, "stdout/32.txt", NULL },
+    { "stream with value", { "--stream", "hex2bin", "1", NULL }, NULL, 255, "stdout/32.txt",
+      NULL },
+    { "stream and range", { "--stream", "hex2bin", "--range", "0:1", NULL }, NULL, 255,
+      "stdout/32.txt", NULL },
+    /* Register layouts. */
+    { "layout", { "--layout", "layout/ctrl.txt", "0x1205", NULL }, NULL, 0,
+      "stdout/layout_ctrl.txt", NULL },
+    { "layout batch", { "--separators", "_", "--layout", "layout/ctrl.txt", "-", NULL },
+      "0x5\t1_0b\n", 0, NULL,
+      "0x5 ENABLE=on MODE=sleep COUNT=0\n1_0b ENABLE=off MODE=run COUNT=0\n" },
+    { "layout batch blank separator",
+      { "--separators", " ", "--layout", "layout/ctrl.txt", "-", NULL }, " 1010 0101b \n10 b\n", 255,
+      NULL, "1010 0101b ENABLE=on MODE=sleep COUNT=0\n10 b invalid\n" },
+    { "layout batch invalid", { "--layout", "layout/ctrl.txt", "-", NULL }, "12g 1\n", 255, NULL,
+      "12g invalid\n1 ENABLE=on MODE=idle COUNT=0\n" },
+    { "invalid layout value", { "--layout", "layout/ctrl.txt", "0xg", NULL }, NULL, 255,
+      "stdout/32.txt", NULL },
+    { "missing layout", { "--layout", "layout/missing.txt", "1", NULL }, NULL, 255,
+      "stdout/32.txt", NULL, "layout/missing.txt: layout can not be read\n" },
+    { "invalid layout line", { "--layout", "layout/invalid.txt", "1", NULL }, NULL, 255,
+      "stdout/32.txt", NULL, "layout/invalid.txt: layout line 3 invalid\n" },
+    { "layout and range", { "--layout", "layout/ctrl.txt", "--range", "0:1", NULL }, NULL, 255,
+      "stdout/32.txt", NULL },
+};
+
+static const TableCase TableCases[] = {
+    { "00000000000000000000", true, 0ull },
+    { "000000000000000000000", false, 0ull },
+    { "09999999999999999999", true, 9999999999999999999ull },
+    { "10000000000000000000", true, 10000000000000000000ull },
+    { "18446744073709551614", true, 18446744073709551614ull },
+    { "18446744073709551605", true, 18446744073709551605ull },
+    { "18446744073709551619", false, 0ull },
+    { "18446744073709551700", false, 0ull },
+    { "18446744073709552615", false, 0ull },
+    { "19446744073709551615", false, 0ull },
+    { "28446744073709551615", false, 0ull },
+    { "99999999999999999999", false, 0ull },
+    { "1", true, 1ull },
+    { "1b", true, 1ull },
+    { "01b", true, 1ull },
+    { "10b", true, 2ull },
+    { "0000000000000000000000000000000000000000000000000000000000000001b", true, 1ull },
+    { "00000000000000000000000000000000000000000000000000000000000000001b", false, 0ull },
+    { "1h", true, 1ull },
+    { "0x1", true, 1ull },
+    { "0x10", true, 16ull },
+    { "10h", true, 16ull },
+    { "0x0000000000000001", true, 1ull },
+    { "0x00000000000000001", false, 0ull },
+    { "0000000000000001h", true, 1ull },
+    { "00000000000000001h", false, 0ull },
+    { "0x1b", true, 0x1bull },
+    { "1bh", true, 0x1bull },
+    { "0x10b", true, 0x10bull },
+    { "0xfFfFfFfFfFfFfFfF", true, 0xffffffffffffffffull },
+    { "FfFfFfFfFfFfFfFfH", true, 0xffffffffffffffffull },
+    { "0b0", false, 0ull },
+    { "0bh", true, 0xbull },
+    { "bh", true, 0xbull },
+    { "hh", false, 0ull },
+    { "xh", false, 0ull },
+    { "0xh", false, 0ull },
+    { "x0", false, 0ull },
+    { "0x0x", false, 0ull },
+    { "2b", false, 0ull },
+    { "+1", false, 0ull },
+    { " 1", false, 0ull },
+    { "1 ", false, 0ull },
+    { "0x 1", false, 0ull },
+    { "0x-1", false, 0ull },
+};
+
+/*!
+ * \brief A table-driven test case with digit separators.
+ */
+typedef struct {
+    const char *input;      /*!< The numeric string with separators. */
+    const char *separators; /*!< The separator characters. */
+    bool isValid;           /*!< true if numconvert should accept the numeric string. */
+    uint64_t number;        /*!< The number represented by input when isValid is true. */
+} SeparatorCase;
+
+static const SeparatorCase SeparatorCases[] = {
+    { "0xdead_beef", "_", true, 0xdeadbeefull },
+    { "1'000'000", "'", true, 1000000ull },
+    { "1,000,000", ",", true, 1000000ull },
+    { "1010 1100b", " ", true, 0xacull },
+    { "0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0100 0010b", " ", true,
+      0x42ull },
+    { "1 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0000 0100 0010b", " ", false,
+      0ull },
+    { "18_446_744_073_709_551_615", "_", true, 18446744073709551615ull },
+    { "18_446_744_073_709_551_616", "_", false, 0ull },
+    { "0xffff_ffff_ffff_ffff", "_", true, 0xffffffffffffffffull },
+    { "0x1_ffff_ffff_ffff_ffff", "_", false, 0ull },
+    { "ffff_ffff_ffff_ffffh", "_", true, 0xffffffffffffffffull },
+    { "1__2", "_", true, 12ull },
+    { "_1_", "_", false, 0ull },
+    { "_1", "_", false, 0ull },
+    { "1_", "_", false, 0ull },
+    { "0x_1", "_", false, 0ull },
+    { "0_x10", "_", false, 0ull },
+    { "1_b", "_", false, 0ull },
+    { "10 b", " ", false, 0ull },
+    { "1_0h", "_", true, 0x10ull },
+    { "0x1_b", "_", true, 0x1bull },
+    { "1_0B", "_", true, 2ull },
+    { "__", "_", false, 0ull },
+    { "1_000", ",", false, 0ull },
+    { "1,0'0_0 0", ",'_ ", true, 10000ull },
+};
+
+static uint64_t RandomState = 0x9e3779b97f4a7c15ull;
+static uint32_t FailureCount = 0;
+
+/*!
+ * \brief Return the next pseudo random number (xorshift64*).
+ * \returns
+ *      A pseudo random number.
+ */
+static uint64_t Random(void)
+{
+    RandomState ^= RandomState >> 12;
+    RandomState ^= RandomState << 25;
+    RandomState ^= RandomState >> 27;
+
+    return RandomState * 0x2545f4914f6cdd1dull;
+}
+
+/*!
+ * \brief Return a pseudo random number with a random bit length, to cover all magnitudes.
  * \returns
- *      true if the character represents a valid Decimal character, otherwise false.
+ *      A pseudo random number between 0 and UINT64_MAX.
  */
-static bool IsDecimalChar(char c)
+static uint64_t RandomNumber(void)
 {
-    bool isDecimalChar = false;
+    uint32_t bits = (uint32_t)(Random() % 65u);
 
-    if ((c >= '0') && (c <= '9')) {
-        isDecimalChar = true;
+    if (bits == 0) {
+        return 0;
     }
 
-    return isDecimalChar;
+    return Random() >> (64u - bits);
 }
 
 /*!
- * \brief Indicate if a string represents a valid Decimal value.
+ * \brief Reference model: indicate if a character is a digit in the given base.
+ * \param c
+ *      The lowercase character to verify.
+ * \param base
+ *      2, 10 or 16.
+ * \returns
+ *      true if the character is a digit in base, otherwise false.
+ */
+static bool RefIsDigit(char c, int base)
+{
+    if (base == 2) {
+        return ((c == '0') || (c == '1'));
+    } else if (base == 10) {
+        return ((c >= '0') && (c <= '9'));
+    }
+
+    return (((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f')));
+}
+
+/*!
+ * \brief Reference model: convert a range of digits with strtoull().
  * \param string
- *      The string to verify.
+ *      The lowercase numeric string.
+ * \param start
+ *      The index of the first digit.
+ * \param end
+ *      The index behind the last digit.
+ * \param base
+ *      2, 10 or 16.
+ * \param[out] number
+ *      The number represented by the digits.
+ * \returns
+ *      true if the digits are valid and fit in an uint64_t, otherwise false.
+ */
+static bool RefConvertDigits(const char *string, size_t start, size_t end, int base,
+                             uint64_t *number)
+{
+    char digits[STRING_LENGTH_MAX];
+    size_t i = 0;
+
+    if (start >= end) {
+        return false;
+    }
+
+    for (i = start; i < end; i++) {
+        if (RefIsDigit(string[i], base) == false) {
+            return false;
+        }
+        digits[i - start] = string[i];
+    }
+    digits[end - start] = '\0';
+
+    errno = 0;
+    *number = strtoull(digits, NULL, base);
+
+    return (errno != ERANGE);
+}
+
+/*!
+ * \brief Reference model: convert a command line argument the way numconvert is specified to.
+ * \param input
+ *      The command line argument, in any case.
  * \param len
  *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the input when it is valid.
  * \returns
- *      true if the string represents a valid Decimal value, otherwise false.
+ *      true if the input is valid, otherwise false.
  */
-static bool IsDecimal(const char *string, size_t len)
+static bool RefConvert(const char *input, size_t len, uint64_t *number)
 {
-    bool isDecimal = true;
-    uint64_t i = 0;
+    char string[STRING_LENGTH_MAX];
+    size_t i = 0;
+
+    if ((len == 0) || (len > ARGUMENT_LEN_MAX)) {
+        return false;
+    }
+
+    for (i = 0; i < len; i++) {
+        string[i] = (char)(((input[i] >= 'A') && (input[i] <= 'Z')) ? (input[i] + 0x20) : input[i]);
+    }
+    string[len] = '\0';
 
+    /* Binary is checked first, f.e. "0x1b" is not Binary but "1b" is. */
+    if ((string[len - 1] == 'b') && (RefConvertDigits(string, 0, len - 1, 2, number) == true)) {
+        return true;
+    }
+
+    if (RefConvertDigits(string, 0, len, 10, number) == true) {
+        return (len <= 20u);
+    }
     for (i = 0; i < len; i++) {
-        if (IsDecimalChar(string[i]) == false) {
-            isDecimal = false;
+        if (RefIsDigit(string[i], 10) == false) {
             break;
         }
     }
+    if (i == len) {
+        /* All Decimal digits, but too large. */
+        return false;
+    }
 
-    if (isDecimal == true) {
-        if (len == 0) {
-            isDecimal = false;
-        } else if (len == DECIMAL_STRING_LEN_MAX) {
-            for (i = 0; i < DECIMAL_STRING_LEN_MAX; i++) {
-                if ((string[i] - 0x30) > (DecimalStringValueMax[i] - 0x30)) {
-                    /* This isn't gonna fit in UINT64_MAX. */
-                    isDecimal = false;
-                    break;
-                } else if ((string[i] - 0x30) == (DecimalStringValueMax[i] - 0x30)) {
-                    /* Continue checking the lower digits, it can still become too large. */
-                    continue;
-                } else {
-                    /* No need to continue checking the lower digits, it cannot become too large. */
-                    break;
-                }
+    if (string[len - 1] == 'h') {
+        return ((len <= 17u) && (RefConvertDigits(string, 0, len - 1, 16, number) == true));
+    }
+
+    if ((len >= 2) && (string[0] == '0') && (string[1] == 'x')) {
+        return ((len <= 18u) && (RefConvertDigits(string, 2, len, 16, number) == true));
+    }
+
+    return false;
+}
+
+/*!
+ * \brief Reference model: check that every separator has a digit on both sides.
+ * \details
+ *      A digit is a Hexadecimal character that is not part of the 0x prefix or the b/h postfix,
+ *      consecutive separators are skipped to find the neighbours.
+ * \param input
+ *      The command line argument, in any case.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param separators
+ *      The digit separator characters.
+ * \returns
+ *      true if all separators are between digits, otherwise false.
+ */
+static bool RefSeparatorsValid(const char *input, size_t len, const char *separators)
+{
+    char string[STRING_LENGTH_MAX];
+    size_t first = 0;
+    size_t last = len;
+    size_t before = 0;
+    size_t after = 0;
+    size_t i = 0;
+
+    for (i = 0; i < len; i++) {
+        string[i] = (char)(((input[i] >= 'A') && (input[i] <= 'Z')) ? (input[i] + 0x20) : input[i]);
+    }
+
+    if ((len >= 2) && (string[0] == '0') && (string[1] == 'x')) {
+        first = 2;
+    } else if ((len >= 1) && ((string[len - 1] == 'b') || (string[len - 1] == 'h'))) {
+        last = len - 1;
+    }
+
+    for (i = 0; i < len; i++) {
+        if (strchr(separators, string[i]) == NULL) {
+            continue;
+        }
+
+        for (before = i; (before > 0) && (strchr(separators, string[before - 1]) != NULL);
+             before--) {
+        }
+        for (after = i + 1; (after < len) && (strchr(separators, string[after]) != NULL);
+             after++) {
+        }
+        if ((before == 0) || (after == len) || ((before - 1) < first) || (after >= last) ||
+            (RefIsDigit(string[before - 1], 16) == false) ||
+            (RefIsDigit(string[after], 16) == false)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Reference model: format a number as 64 Binary digits, grouped per nibble.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least BINARY_FORMAT_SIZE bytes.
+ */
+static void RefFormatBinary(uint64_t number, char *buf)
+{
+    size_t len = 0;
+    int i = 0;
+
+    for (i = 63; i >= 0; i--) {
+        buf[len++] = ((number >> i) & 0x1) ? '1' : '0';
+        if ((i != 0) && ((i % 4) == 0)) {
+            buf[len++] = ' ';
+        }
+    }
+    buf[len] = '\0';
+}
+
+/*!
+ * \brief Report a failed case, only the first FAILURE_REPORT_MAX failures are printed.
+ * \param kind
+ *      The kind of case, f.e. "parse".
+ * \param input
+ *      The case input.
+ * \param output
+ *      The produced output.
+ * \param expected
+ *      The expected output.
+ */
+static void ReportFailure(const char *kind, const char *input, const char *output,
+                          const char *expected)
+{
+    FailureCount++;
+
+    if (FailureCount <= FAILURE_REPORT_MAX) {
+        printf("  %s mismatch for \"%s\"\n", kind, input);
+        printf("  output:          %s\n", output);
+        printf("  expected output: %s\n", expected);
+    }
+}
+
+/*!
+ * \brief Compare the conversion of a numeric string against the reference model.
+ * \param input
+ *      The numeric string, in any case.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param separators
+ *      The digit separator characters or NULL for none.
+ * \returns
+ *      true if numconvert and the reference model agree, otherwise false.
+ */
+static bool CheckConversion(const char *input, size_t len, const char *separators)
+{
+    char output[STRING_LENGTH_MAX];
+    char expected[STRING_LENGTH_MAX];
+    char stripped[STRING_LENGTH_MAX];
+    uint64_t number = 0;
+    uint64_t refNumber = 0;
+    size_t strippedLen = 0;
+    size_t i = 0;
+    bool isValid = false;
+    bool refIsValid = false;
+
+    if (separators == NULL) {
+        isValid = (ConvertString(input, len, &number) == 0);
+        refIsValid = RefConvert(input, len, &refNumber);
+    } else {
+        /* The reference checks the separator positions and removes them before converting. */
+        for (i = 0; i < len; i++) {
+            if (strchr(separators, input[i]) == NULL) {
+                stripped[strippedLen++] = input[i];
             }
         }
+        stripped[strippedLen] = '\0';
+
+        isValid = (ConvertSeparatedString(input, len, separators, &number) == 0);
+        refIsValid = (RefSeparatorsValid(input, len, separators) == true) &&
+                     (RefConvert(stripped, strippedLen, &refNumber) == true);
+    }
+
+    if ((isValid != refIsValid) || ((isValid == true) && (number != refNumber))) {
+        snprintf(output, sizeof(output), isValid ? "%llu" : "rejected", (unsigned long long)number);
+        snprintf(expected, sizeof(expected), refIsValid ? "%llu" : "rejected",
+                 (unsigned long long)refNumber);
+        ReportFailure("parse", input, output, expected);
+        return false;
     }
 
-    return isDecimal;
+    return true;
 }
 
 /*!
- * \brief This is the program entry.
+ * \brief Insert random separators into a numeric string.
  * \details
- *      Test an executable with a list of input arguments and compare its returned value and stdout
- *      data to a predefined set.
- *
- *      Expected arguments:
- *          argv[0] is this executable path
- *          argv[1] is the test name, f.e. "1" or "1a"
- *          argv[2] is the test executable system path, f.e. "./numconvert"
- *          argv[3] is the test input value, f.e. "0x12" or "" or even "1 2"
- *          argv[4] is the test expected return value, f.e. "0" between 0 and 255
- *          argv[5] is the test file that contains the expected (stdout)output, f.e. "tests/1.txt"
- * \param argc
- *      The number of string pointed to by argv (argument count).
- * \param argv
- *      A list of strings (argument vector).
+ *      Most strings only get separators between their characters, the others anywhere.
+ * \param[in,out] string
+ *      The string to modify, at least STRING_LENGTH_MAX bytes.
+ * \param len
+ *      The length of the string (excluding the string terminator).
  * \returns
- *      0 in case of successful completion or any other value in case of an error.
+ *      The new length of the string (excluding the string terminator).
  */
-int main(int argc, char *argv[])
+static size_t InsertSeparators(char *string, size_t len)
 {
-    char *stdoutLine = 0;
-    char *stdoutExpLine = 0;
-    char stdoutString[STDOUT_STRING_LENGTH_MAX];
-    char stdoutExpString[STDOUT_STRING_LENGTH_MAX];
-    char string[STRING_LENGTH_MAX];
-    int retval = 0;
-    int stdoutStrLen = 0;
-    int stdoutExpStrLen = 0;
-    uint32_t i = 0;
-    uint32_t lineNumber = 0;
-    FILE *stdoutFp = 0;
-    FILE *stdoutExpFp = 0;
+    size_t count = (size_t)(Random() % 24u);
+    bool isInside = ((Random() % 4u) != 0) && (len >= 2u);
+    size_t position = 0;
+    size_t i = 0;
 
-    if (argc >= 2) {
-        printf("Test %s:", argv[1]);
+    for (i = 0; (i < count) && (len < (STRING_LENGTH_MAX - 1u)); i++) {
+        if (isInside == true) {
+            position = 1u + (size_t)(Random() % (len - 1u));
+        } else {
+            position = (size_t)(Random() % (len + 1u));
+        }
+        memmove(&string[position + 1u], &string[position], len - position + 1u);
+        string[position] = SEPARATORS[Random() % (sizeof(SEPARATORS) - 1u)];
+        len++;
     }
 
-    /* Check arguments. */
-    if (argc != 6) {
-        /* Missing or too many arguments. */
-        printf("argument mismatch\n");
-        return -1;
+    return len;
+}
+
+/*!
+ * \brief Compare the formatting of a number against snprintf() and the reference model.
+ * \param number
+ *      The number to format.
+ * \returns
+ *      true if all formats match, otherwise false.
+ */
+static bool CheckFormat(uint64_t number)
+{
+    char input[STRING_LENGTH_MAX];
+    char output[BINARY_FORMAT_SIZE];
+    char expected[BINARY_FORMAT_SIZE];
+    bool isEqual = true;
+
+    snprintf(input, sizeof(input), "%llu", (unsigned long long)number);
+
+    (void)FormatDecimal(number, output);
+    snprintf(expected, sizeof(expected), "%llu", (unsigned long long)number);
+    if (strcmp(output, expected) != 0) {
+        ReportFailure("decimal format", input, output, expected);
+        isEqual = false;
     }
 
-    if (IsDecimal(argv[4], strlen(argv[4])) == false) {
-        /* The given return value is not a decimal character. */
-        printf("invalid expected return value\n");
-        return -1;
+    (void)FormatHexadecimal(number, output);
+    snprintf(expected, sizeof(expected), "0x%llx", (unsigned long long)number);
+    if (strcmp(output, expected) != 0) {
+        ReportFailure("hexadecimal format", input, output, expected);
+        isEqual = false;
     }
 
-    snprintf(string, STRING_LENGTH_MAX, "%s %s", argv[2], argv[3]);
+    (void)FormatBinary(number, output);
+    RefFormatBinary(number, expected);
+    if (strcmp(output, expected) != 0) {
+        ReportFailure("binary format", input, output, expected);
+        isEqual = false;
+    }
 
-    stdoutFp = popen(string, "r");
-    if (stdoutFp == NULL) {
-        printf("unable to open test executable\n");
-        return -1;
+    return isEqual;
+}
+
+/*!
+ * \brief Randomize the case of all letters in a string.
+ * \param[in,out] string
+ *      The string to modify.
+ * \param len
+ *      The length of the string (excluding the string terminator).
+ */
+static void RandomizeCase(char *string, size_t len)
+{
+    uint64_t bits = Random();
+    size_t i = 0;
+
+    for (i = 0; i < len; i++) {
+        if ((string[i] >= 'a') && (string[i] <= 'z') && (((bits >> (i % 64u)) & 0x1) == 0x1)) {
+            string[i] = (char)(string[i] - 0x20);
+        }
+    }
+}
+
+/*!
+ * \brief Generate a random, mostly valid, numeric string.
+ * \param[out] string
+ *      The generated string, at least STRING_LENGTH_MAX bytes.
+ * \param[out] number
+ *      The number the string was generated from, if any.
+ * \returns
+ *      The length of the generated string (excluding the string terminator).
+ */
+static size_t GenerateString(char *string, uint64_t *number)
+{
+    static const char alphabet[] = "0123456789abcdefABCDEFxXhHbB /-+g";
+    uint64_t selector = Random();
+    size_t len = 0;
+    size_t zeros = (size_t)((selector >> 8) % 4u);
+    size_t i = 0;
+    int bit = 0;
+
+    *number = RandomNumber();
+
+    switch (selector % 8u) {
+        case 0:
+            len = (size_t)snprintf(string, STRING_LENGTH_MAX, "%0*llu", (int)(zeros * 7u),
+                                   (unsigned long long)*number);
+            break;
+        case 1:
+            len = (size_t)snprintf(string, STRING_LENGTH_MAX, "0x%0*llx", (int)(zeros * 6u),
+                                   (unsigned long long)*number);
+            break;
+        case 2:
+            len = (size_t)snprintf(string, STRING_LENGTH_MAX, "%0*llxh", (int)(zeros * 6u),
+                                   (unsigned long long)*number);
+            break;
+        case 3:
+            bit = 63;
+            while ((bit > 0) && (((*number >> bit) & 0x1) == 0)) {
+                bit--;
+            }
+            for (i = 0; i < (zeros * 22u) % 40u; i++) {
+                string[len++] = '0';
+            }
+            for (; bit >= 0; bit--) {
+                string[len++] = (char)('0' + ((*number >> bit) & 0x1));
+            }
+            string[len++] = 'b';
+            string[len] = '\0';
+            break;
+        case 4:
+            /* Around UINT64_MAX, in Decimal. */
+            len = (size_t)snprintf(string, STRING_LENGTH_MAX, "18446744073709%06llu",
+                                   (unsigned long long)(540000u + (Random() % 20000u)));
+            break;
+        case 5:
+            /* Random characters. */
+            len = (size_t)(Random() % 70u);
+            for (i = 0; i < len; i++) {
+                string[i] = alphabet[Random() % (sizeof(alphabet) - 1u)];
+            }
+            string[len] = '\0';
+            break;
+        default:
+            /* Mutate a single character of a valid string. */
+            len = (size_t)snprintf(string, STRING_LENGTH_MAX, "0x%llx", (unsigned long long)*number);
+            if ((selector % 8u) == 7u) {
+                len = (size_t)snprintf(string, STRING_LENGTH_MAX, "%llu", (unsigned long long)*number);
+            }
+            string[Random() % len] = alphabet[Random() % (sizeof(alphabet) - 1u)];
+            break;
     }
-    stdoutExpFp = fopen(argv[5], "r");
+
+    RandomizeCase(string, len);
+
+    return len;
+}
+
+/*!
+ * \brief Read a file with expected stdout output.
+ * \param file
+ *      The file name.
+ * \param[out] expected
+ *      The file contents, at least STDOUT_FILE_SIZE_MAX bytes.
+ * \param[out] expectedLen
+ *      The length of the file contents.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int ReadExpectedFile(const char *file, char *expected, size_t *expectedLen)
+{
+    FILE *stdoutExpFp = fopen(file, "rb");
+
     if (stdoutExpFp == NULL) {
         printf("unable to open file with expected stdout output\n");
         return -1;
     }
+    *expectedLen = fread(expected, 1, STDOUT_FILE_SIZE_MAX, stdoutExpFp);
+    (void)fclose(stdoutExpFp);
 
-    lineNumber = 0;
-    while (1) {
-        lineNumber++;
+    return 0;
+}
 
-        stdoutLine = fgets(stdoutString, sizeof(stdoutString), stdoutFp);
-        if (stdoutLine == NULL) {
-            stdoutExpLine = fgets(stdoutExpString, sizeof(stdoutExpString), stdoutExpFp);
-            if (stdoutExpLine != NULL) {
-                printf("stdout mismatch\n");
+/*!
+ * \brief Compare the output and exit status of a test case and print the result.
+ * \param output
+ *      The stdout output.
+ * \param outputLen
+ *      The length of the stdout output.
+ * \param expected
+ *      The expected stdout output, or NULL to not compare it.
+ * \param expectedLen
+ *      The length of the expected stdout output.
+ * \param retval
+ *      The exit status.
+ * \param expectedRetval
+ *      The expected exit status.
+ * \param exitCode
+ *      The exit code so far.
+ * \returns
+ *      The exit code including the result of this test case.
+ */
+static int CheckOutput(const char *output, size_t outputLen, const char *expected,
+                       size_t expectedLen, int retval, int expectedRetval, int exitCode)
+{
+    uint32_t lineNumber = 1;
+    uint32_t column = 1;
+    size_t j = 0;
 
-                printf("  line %u (stdout strlen < stdout expected strlen)\n", lineNumber);
-                printf("  output:\n");
-                printf("  expected output: %s\n", stdoutExpLine);
-                return STDIO_OUTPUT_FAILURE_CODE;
+    if (expected != NULL) {
+        /* Find the first mismatching character, if any. */
+        for (j = 0; (j < outputLen) && (j < expectedLen) && (output[j] == expected[j]); j++) {
+            column++;
+            if (output[j] == '\n') {
+                lineNumber++;
+                column = 1;
             }
-            break;
         }
 
-        stdoutExpLine = fgets(stdoutExpString, sizeof(stdoutExpString), stdoutExpFp);
-        if (stdoutExpLine == NULL) {
+        if ((j != outputLen) || (j != expectedLen)) {
             printf("stdout mismatch\n");
-
-            printf("  line %u (stdout output > stdout expected output)\n", lineNumber);
-            printf("  output:       %s", stdoutLine);
-            printf("  check output:\n");
+            printf("  line %u:%u\n", lineNumber, column);
             return STDIO_OUTPUT_FAILURE_CODE;
         }
+    }
 
-        /* Check string length. */
-        stdoutStrLen = strlen(stdoutLine);
-        stdoutExpStrLen = strlen(stdoutExpLine);
-        if (stdoutStrLen > stdoutExpStrLen) {
-            printf("stdout mismatch\n");
+    if (retval != expectedRetval) {
+        printf("return value mismatch\n");
+        printf("  got %d expected %d\n", retval, expectedRetval);
+        return RETURN_VALUE_FAILURE_CODE;
+    }
 
-            printf("  line %u (stdout strlen > stdout expected strlen)\n", lineNumber);
-            printf("  output:       %s", stdoutLine);
-            printf("  expected output: %s\n", stdoutExpLine);
-            return STDIO_OUTPUT_FAILURE_CODE;
-        } else if (stdoutStrLen < stdoutExpStrLen) {
-            printf("stdout mismatch\n");
+    printf("successful\n");
 
-            printf("  line %u (stdout strlen < stdout expected strlen)\n", lineNumber);
-            printf("  output:       %s", stdoutLine);
-            printf("  expected output: %s\n", stdoutExpLine);
-            return STDIO_OUTPUT_FAILURE_CODE;
+    return exitCode;
+}
+
+/*!
+ * \brief Close both ends of a pipe, when open.
+ * \param fds
+ *      The pipe file descriptors, set to -1 when closed.
+ */
+static void ClosePipe(int fds[2])
+{
+    if (fds[0] >= 0) {
+        (void)close(fds[0]);
+        fds[0] = -1;
+    }
+    if (fds[1] >= 0) {
+        (void)close(fds[1]);
+        fds[1] = -1;
+    }
+}
+
+/*!
+ * \brief Run a program with arguments and stdin input and collect its stdout output.
+ * \details
+ *      The stderr output of the program is discarded.
+ * \param program
+ *      The program to run.
+ * \param args
+ *      The arguments, NULL terminated.
+ * \param input
+ *      The stdin input or NULL for none.
+ * \param outputPath
+ *      The file that stdout is redirected to instead of collecting it, or NULL.
+ * \param errorFd
+ *      The file descriptor that stderr is redirected to, or -1 to discard it.
+ * \param[out] output
+ *      The stdout output, at least COMMAND_OUTPUT_SIZE_MAX bytes. Longer output is truncated.
+ * \param[out] outputLen
+ *      The length of the stdout output.
+ * \param[out] status
+ *      The exit status of the program.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int RunCommand(const char *program, const char * const *args, const char *input,
+                      const char *outputPath, int errorFd, char *output, size_t *outputLen,
+                      int *status)
+{
+    char *argv[COMMAND_ARGUMENTS_MAX + 1u];
+    char discard[256];
+    int inPipe[2] = { -1, -1 };
+    int outPipe[2] = { -1, -1 };
+    int waitStatus = 0;
+    int devNull = -1;
+    int outputFd = -1;
+    int writeError = 0;
+    ssize_t len = 0;
+    size_t i = 0;
+    pid_t pid = 0;
+
+    argv[0] = (char *)program;
+    for (i = 0; args[i] != NULL; i++) {
+        argv[i + 1u] = (char *)args[i];
+    }
+    argv[i + 1u] = NULL;
+
+    if ((pipe(inPipe) != 0) || (pipe(outPipe) != 0)) {
+        ClosePipe(inPipe);
+        return -1;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        ClosePipe(inPipe);
+        ClosePipe(outPipe);
+        return -1;
+    }
+
+    if (pid == 0) {
+        devNull = open("/dev/null", O_WRONLY);
+        outputFd = (outputPath != NULL) ? open(outputPath, O_WRONLY) : outPipe[1];
+        (void)dup2(inPipe[0], STDIN_FILENO);
+        (void)dup2(outputFd, STDOUT_FILENO);
+        (void)dup2((errorFd >= 0) ? errorFd : devNull, STDERR_FILENO);
+        (void)close(outPipe[1]);
+        (void)close(inPipe[1]);
+        (void)close(outPipe[0]);
+        (void)execv(program, argv);
+        _exit(127);
+    }
+
+    (void)close(inPipe[0]);
+    (void)close(outPipe[1]);
+
+    /*
+     * The inputs are far smaller than a pipe buffer, so this never blocks. EPIPE means that the
+     * program exited without reading its input, which is fine (SIGPIPE is ignored).
+     */
+    if ((input != NULL) && (write(inPipe[1], input, strlen(input)) < 0) && (errno != EPIPE)) {
+        writeError = errno;
+    }
+    (void)close(inPipe[1]);
+
+    *outputLen = 0;
+    while ((len = read(outPipe[0], &output[*outputLen],
+                       COMMAND_OUTPUT_SIZE_MAX - *outputLen)) > 0) {
+        *outputLen += (size_t)len;
+        if (*outputLen == COMMAND_OUTPUT_SIZE_MAX) {
+            while (read(outPipe[0], discard, sizeof(discard)) > 0) {
+            }
+            break;
         }
+    }
+    (void)close(outPipe[0]);
 
-        /* Check characters. */
-        for (i = 0; i < strlen(stdoutLine); i++) {
-            if (stdoutLine[i] != stdoutExpLine[i]) {
-                printf("stdout mismatch\n");
+    if ((waitpid(pid, &waitStatus, 0) != pid) || (WIFEXITED(waitStatus) == 0) ||
+        (writeError != 0)) {
+        return -1;
+    }
+    *status = WEXITSTATUS(waitStatus);
+
+    return 0;
+}
+
+/*!
+ * \brief Run the golden-file cases and the option combinations against the numconvert executable.
+ * \param program
+ *      The numconvert executable.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int RunCommandCases(const char *program)
+{
+    static char output[COMMAND_OUTPUT_SIZE_MAX];
+    static char expected[STDOUT_FILE_SIZE_MAX];
+    const char *args[COMMAND_ARGUMENTS_MAX];
+    const char *expectedOutput = NULL;
+    char errors[256];
+    char shmName[64];
+    FILE *errorFile = NULL;
+    size_t errorsLen = 0;
+    size_t outputLen = 0;
+    size_t expectedLen = 0;
+    size_t i = 0;
+    int status = 0;
+    int exitCode = 0;
+    int fd = -1;
 
-                printf("  line %u:%u\n", lineNumber, i + 1);
-                printf("  output:       %s", stdoutLine);
-                printf("  expected output: %s\n", stdoutExpLine);
-                return STDIO_OUTPUT_FAILURE_CODE;
+    /* A program that exits before reading its input must not kill the runner. */
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    for (i = 0; i < (sizeof(GoldenCases) / sizeof(GoldenCases[0])); i++) {
+        printf("Command %s:", GoldenCases[i].name);
+
+        args[0] = GoldenCases[i].input;
+        args[1] = NULL;
+        if ((ReadExpectedFile(GoldenCases[i].file, expected, &expectedLen) != 0) ||
+            (RunCommand(program, args, NULL, NULL, -1, output, &outputLen, &status) != 0)) {
+            printf("unable to run %s\n", program);
+            exitCode = STDIO_OUTPUT_FAILURE_CODE;
+            continue;
+        }
+
+        exitCode = CheckOutput(output, outputLen, expected, expectedLen, status,
+                               GoldenCases[i].retval, exitCode);
+    }
+
+    for (i = 0; i < (sizeof(CommandCases) / sizeof(CommandCases[0])); i++) {
+        printf("Command %s:", CommandCases[i].name);
+
+        expectedOutput = CommandCases[i].output;
+        expectedLen = (expectedOutput != NULL) ? strlen(expectedOutput) : 0;
+        if (CommandCases[i].file != NULL) {
+            if (ReadExpectedFile(CommandCases[i].file, expected, &expectedLen) != 0) {
+                exitCode = STDIO_OUTPUT_FAILURE_CODE;
+                continue;
             }
+            expectedOutput = expected;
         }
+
+        /* The stderr output is collected in a temporary file, it is small and read afterwards. */
+        errorFile = (CommandCases[i].errors != NULL) ? tmpfile() : NULL;
+        if (((CommandCases[i].errors != NULL) && (errorFile == NULL)) ||
+            (RunCommand(program, CommandCases[i].args, CommandCases[i].input, NULL,
+                        (errorFile != NULL) ? fileno(errorFile) : -1, output, &outputLen,
+                        &status) != 0)) {
+            printf("unable to run %s\n", program);
+            exitCode = STDIO_OUTPUT_FAILURE_CODE;
+            if (errorFile != NULL) {
+                (void)fclose(errorFile);
+            }
+            continue;
+        }
+
+        if (errorFile != NULL) {
+            rewind(errorFile);
+            errorsLen = fread(errors, 1, sizeof(errors) - 1u, errorFile);
+            errors[errorsLen] = '\0';
+            (void)fclose(errorFile);
+            if (strcmp(errors, CommandCases[i].errors) != 0) {
+                printf("stderr mismatch\n");
+                printf("  got \"%s\"\n", errors);
+                exitCode = STDIO_OUTPUT_FAILURE_CODE;
+                continue;
+            }
+        }
+
+        exitCode = CheckOutput(output, outputLen, expectedOutput, expectedLen, status,
+                               CommandCases[i].retval, exitCode);
     }
 
-    /* Close the process and get the return value.
-     *
-     * Regarding the return value conversion:
-     *
-     * To quote from bash man page on EXIT STATUS
-     * The exit status of an executed command is the value returned by the waitpid system call or
-     * equivalent function.
-     * Exit statuses fall between 0 and 255, though, as explained below, the shell may use values
-     * above 125 specially.
-     * Exit statuses from shell builtins and compound commands are also limited to this range.
-     * Under certain circumstances, the shell will use special values to indicate specific failure
-     * modes.
-     */
-    retval = WEXITSTATUS(pclose(stdoutFp));
-    if (retval != atoi(argv[4])) {
-        printf("return value mismatch\n");
-        printf("  got %d expected %d\n", retval, atoi(argv[4]));
-        return RETURN_VALUE_FAILURE_CODE;
+    /* A shared-memory object that already exists, f.e. in use by another server, is refused. */
+    printf("Command shm exists:");
+    (void)snprintf(shmName, sizeof(shmName), "/numconvert_functional_%ld", (long)getpid());
+    fd = shm_open(shmName, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    args[0] = "--shm";
+    args[1] = shmName;
+    args[2] = NULL;
+    if ((fd < 0) || (RunCommand(program, args, NULL, NULL, -1, output, &outputLen, &status) != 0)) {
+        printf("unable to run %s\n", program);
+        exitCode = STDIO_OUTPUT_FAILURE_CODE;
+    } else {
+        exitCode = CheckOutput(output, outputLen, "", 0, status, 255, exitCode);
+    }
+    if (fd >= 0) {
+        (void)close(fd);
+        (void)shm_unlink(shmName);
     }
 
-    /* Close the stdout output test file. */
-    (void)fclose(stdoutExpFp);
+    /* Output that can not be written, f.e. to a full disk, fails every successful case. */
+    for (i = 0; i < (sizeof(CommandCases) / sizeof(CommandCases[0])); i++) {
+        if ((CommandCases[i].retval != 0) || (access("/dev/full", W_OK) != 0) ||
+            ((CommandCases[i].output != NULL) && (CommandCases[i].output[0] == '\0'))) {
+            /* Failing cases, no /dev/full or nothing to write. */
+            continue;
+        }
+        printf("Command %s to /dev/full:", CommandCases[i].name);
 
-    /* We reached the end, print the result. */
-    printf("successful\n");
+        if (RunCommand(program, CommandCases[i].args, CommandCases[i].input, "/dev/full", -1,
+                       output, &outputLen, &status) != 0) {
+            printf("unable to run %s\n", program);
+            exitCode = STDIO_OUTPUT_FAILURE_CODE;
+            continue;
+        }
 
-    return 0;
+        exitCode = CheckOutput(output, outputLen, "", 0, status, 255, exitCode);
+    }
+
+    return exitCode;
+}
+
+/*!
+ * \brief Run the golden-file cases, compare the console output and return value.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int RunGoldenCases(void)
+{
+    char output[OUTPUT_BUFFER_SIZE];
+    char expected[STDOUT_FILE_SIZE_MAX];
+    size_t outputLen = 0;
+    size_t expectedLen = 0;
+    size_t i = 0;
+    int retval = 0;
+    int exitCode = 0;
+
+    for (i = 0; i < (sizeof(GoldenCases) / sizeof(GoldenCases[0])); i++) {
+        printf("Test %s:", GoldenCases[i].name);
+
+        if (ReadExpectedFile(GoldenCases[i].file, expected, &expectedLen) != 0) {
+            exitCode = STDIO_OUTPUT_FAILURE_CODE;
+            continue;
+        }
+
+        /* The exit status is the return value of main() truncated to 8 bits. */
+        retval = ConvertArgument(GoldenCases[i].input, NULL, output, &outputLen) & 0xff;
+
+        exitCode = CheckOutput(output, outputLen, expected, expectedLen, retval,
+                               GoldenCases[i].retval, exitCode);
+    }
+
+    return exitCode;
+}
+
+/*!
+ * \brief Run the table-driven cases and boundary sweeps against the reference model.
+ * \returns
+ *      The number of executed cases.
+ */
+static uint64_t RunTableCases(void)
+{
+    char string[STRING_LENGTH_MAX];
+    char output[STRING_LENGTH_MAX];
+    uint64_t number = 0;
+    uint64_t count = 0;
+    int64_t delta = 0;
+    size_t len = 0;
+    size_t i = 0;
+    uint32_t bit = 0;
+    uint32_t form = 0;
+    char digit = '\0';
+
+    for (i = 0; i < (sizeof(TableCases) / sizeof(TableCases[0])); i++) {
+        len = strlen(TableCases[i].input);
+        (void)CheckConversion(TableCases[i].input, len, NULL);
+
+        /* The table also pins down the reference model itself. */
+        if ((ConvertString(TableCases[i].input, len, &number) == 0) != TableCases[i].isValid) {
+            ReportFailure("table", TableCases[i].input, "accepted != expected", "");
+        } else if ((TableCases[i].isValid == true) && (number != TableCases[i].number)) {
+            snprintf(output, sizeof(output), "%llu", (unsigned long long)number);
+            ReportFailure("table", TableCases[i].input, output, "table number");
+        }
+        count++;
+    }
+
+    /* Every power of 2 and its neighbours, in every base and notation. */
+    for (bit = 0; bit < 64u; bit++) {
+        for (delta = -1; delta <= 1; delta++) {
+            number = ((uint64_t)1 << bit) + (uint64_t)delta;
+            (void)CheckFormat(number);
+            for (form = 0; form < 4u; form++) {
+                if (form == 0) {
+                    len = (size_t)snprintf(string, sizeof(string), "%llu", (unsigned long long)number);
+                } else if (form == 1) {
+                    len = (size_t)snprintf(string, sizeof(string), "0x%llx", (unsigned long long)number);
+                } else if (form == 2) {
+                    len = (size_t)snprintf(string, sizeof(string), "%llxh", (unsigned long long)number);
+                } else {
+                    RefFormatBinary(number, output);
+                    for (i = 0, len = 0; output[i] != '\0'; i++) {
+                        if (output[i] != ' ') {
+                            string[len++] = output[i];
+                        }
+                    }
+                    string[len++] = 'b';
+                    string[len] = '\0';
+                }
+                (void)CheckConversion(string, len, NULL);
+                count++;
+            }
+        }
+    }
+
+    /* Every digit of UINT64_MAX one lower and one higher, around the Decimal overflow check. */
+    for (i = 0; i < 20u; i++) {
+        for (digit = '0'; digit <= '9'; digit++) {
+            (void)snprintf(string, sizeof(string), "18446744073709551615");
+            string[i] = digit;
+            (void)CheckConversion(string, 20u, NULL);
+            count++;
+        }
+    }
+
+    for (i = 0; i < (sizeof(SeparatorCases) / sizeof(SeparatorCases[0])); i++) {
+        len = strlen(SeparatorCases[i].input);
+        (void)CheckConversion(SeparatorCases[i].input, len, SeparatorCases[i].separators);
+
+        if ((ConvertSeparatedString(SeparatorCases[i].input, len, SeparatorCases[i].separators,
+                                    &number) == 0) != SeparatorCases[i].isValid) {
+            ReportFailure("separator table", SeparatorCases[i].input, "accepted != expected", "");
+        } else if ((SeparatorCases[i].isValid == true) && (number != SeparatorCases[i].number)) {
+            snprintf(output, sizeof(output), "%llu", (unsigned long long)number);
+            ReportFailure("separator table", SeparatorCases[i].input, output, "table number");
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/*!
+ * \brief Run randomly generated cases against the reference model.
+ * \param count
+ *      The number of cases to run.
+ */
+static void RunRandomCases(uint64_t count)
+{
+    char string[STRING_LENGTH_MAX];
+    uint64_t number = 0;
+    uint64_t i = 0;
+    size_t len = 0;
+
+    for (i = 0; i < count; i++) {
+        len = GenerateString(string, &number);
+        if ((i % 2u) == 0) {
+            (void)CheckConversion(string, len, NULL);
+        } else {
+            len = InsertSeparators(string, len);
+            (void)CheckConversion(string, len, SEPARATORS);
+        }
+
+        if ((i % 4u) == 0) {
+            (void)CheckFormat(number);
+        }
+    }
+}
+
+/*!
+ * \brief Check range parsing and compare range formatting against snprintf() per value.
+ * \returns
+ *      The number of executed cases.
+ */
+static uint64_t RunRangeCases(void)
+{
+    static char output[(RANGE_CASE_VALUES_MAX * RANGE_LINE_SIZE_MAX) + RANGE_BLOCK_SLACK];
+    static char expected[(RANGE_CASE_VALUES_MAX * RANGE_LINE_SIZE_MAX) + RANGE_BLOCK_SLACK];
+    char binary[BINARY_FORMAT_SIZE];
+    Range range;
+    uint64_t number = 0;
+    uint64_t first = 0;
+    uint64_t count = 0;
+    uint64_t i = 0;
+    size_t len = 0;
+    size_t expectedLen = 0;
+    size_t j = 0;
+    size_t k = 0;
+
+    if ((ParseRange("0x10:20:3", NULL, &range) != 0) || (range.start != 16u) ||
+        (range.end != 20u) || (range.step != 3u) || (range.count != 2u)) {
+        ReportFailure("range", "0x10:20:3", "", "");
+    }
+    if ((ParseRange("1_0:1_1", "_", &range) != 0) || (range.count != 1u) ||
+        (ParseRange("5:5", NULL, &range) != 0) || (range.count != 0u)) {
+        ReportFailure("range", "1_0:1_1 or 5:5", "", "");
+    }
+    if ((ParseRange("5:4", NULL, &range) == 0) || (ParseRange("1:2:0", NULL, &range) == 0) ||
+        (ParseRange("1:2:3:4", NULL, &range) == 0) || (ParseRange("1", NULL, &range) == 0) ||
+        (ParseRange("1:", NULL, &range) == 0) || (ParseRange(":1", NULL, &range) == 0)) {
+        ReportFailure("range", "invalid range", "accepted", "rejected");
+    }
+
+    for (i = 0; i < RANGE_CASE_COUNT; i++) {
+        range.start = RandomNumber();
+        range.step = ((i % 2u) == 0) ? (1u + (Random() % 20u)) : (1u + RandomNumber());
+        count = 1u + (Random() % RANGE_CASE_VALUES_MAX);
+        first = Random() % 4u;
+
+        /* Keep the last value within UINT64_MAX, shrinking the range where needed. */
+        while ((count > 0) &&
+               (((UINT64_MAX - range.start) / range.step) < (first + count - 1u))) {
+            count /= 2u;
+        }
+        if (count == 0) {
+            continue;
+        }
+        range.count = first + count;
+        range.end = range.start + ((range.count - 1u) * range.step) + 1u;
+
+        len = FormatRangeBlock(&range, first, count, output);
+
+        expectedLen = 0;
+        for (j = 0; j < count; j++) {
+            number = range.start + ((first + j) * range.step);
+            RefFormatBinary(number, binary);
+            expectedLen += (size_t)snprintf(&expected[expectedLen], sizeof(expected) - expectedLen,
+                                            "%llu 0x%llx ", (unsigned long long)number,
+                                            (unsigned long long)number);
+            /* Strip the grouping and the leading zeros, but keep at least 1 digit. */
+            k = 0;
+            while ((binary[k] == '0') || (binary[k] == ' ')) {
+                k++;
+            }
+            if (binary[k] == '\0') {
+                k--;
+            }
+            for (; binary[k] != '\0'; k++) {
+                if (binary[k] != ' ') {
+                    expected[expectedLen++] = binary[k];
+                }
+            }
+            expected[expectedLen++] = 'b';
+            expected[expectedLen++] = '\n';
+        }
+
+        if ((len != expectedLen) || (memcmp(output, expected, len) != 0)) {
+            snprintf(binary, sizeof(binary), "%llu+%llu*%llu", (unsigned long long)range.start,
+                     (unsigned long long)first, (unsigned long long)range.step);
+            ReportFailure("range", binary, "<lines>", "<lines>");
+        }
+    }
+
+    return RANGE_CASE_COUNT;
+}
+
+/*!
+ * \brief Convert a digit stream through temporary files.
+ * \param base
+ *      The input base, 'b' or 'h'.
+ * \param separators
+ *      The separator characters or NULL for none.
+ * \param input
+ *      The input characters.
+ * \param len
+ *      The number of input characters.
+ * \param[out] output
+ *      The output characters, at least STREAM_BUFFER_SIZE bytes. Not terminated.
+ * \param[out] outputLen
+ *      The number of output characters.
+ * \returns
+ *      The return value of ConvertStream() or -1 in case of a file error.
+ */
+static int ConvertThroughFiles(char base, const char *separators, const char *input, size_t len,
+                               char *output, size_t *outputLen)
+{
+    FILE *in = tmpfile();
+    FILE *out = tmpfile();
+    int retval = -1;
+
+    if ((in != NULL) && (out != NULL) && (fwrite(input, 1, len, in) == len)) {
+        rewind(in);
+        retval = ConvertStream(base, separators, in, out);
+        rewind(out);
+        *outputLen = fread(output, 1, STREAM_BUFFER_SIZE, out);
+    }
+
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+
+    return retval;
+}
+
+/*!
+ * \brief Compare streaming Binary/Hexadecimal conversion against a per digit reference.
+ * \returns
+ *      The number of executed cases.
+ */
+static uint64_t RunStreamCases(void)
+{
+    static char hex[STREAM_BUFFER_SIZE];
+    static char binary[STREAM_BUFFER_SIZE];
+    static char input[STREAM_BUFFER_SIZE];
+    static char output[STREAM_BUFFER_SIZE];
+    const char *whitespace = " \t\r\n";
+    char digit[2] = { '\0', '\0' };
+    uint64_t i = 0;
+    size_t digitCount = 0;
+    size_t hexLen = 0;
+    size_t binaryLen = 0;
+    size_t len = 0;
+    size_t outputLen = 0;
+    size_t j = 0;
+    size_t k = 0;
+    unsigned long value = 0;
+
+    if ((ConvertThroughFiles('h', NULL, "dE aD\n", 6, output, &outputLen) != 0) ||
+        (outputLen != 17u) || (memcmp(output, "1101111010101101\n", 17) != 0)) {
+        ReportFailure("stream", "dE aD", "", "1101111010101101");
+    }
+    if ((ConvertThroughFiles('b', "_", "1_0101", 6, output, &outputLen) != 0) ||
+        (outputLen != 3u) || (memcmp(output, "15\n", 3) != 0)) {
+        ReportFailure("stream", "1_0101", "", "15");
+    }
+    if ((ConvertThroughFiles('h', NULL, "", 0, output, &outputLen) == 0) ||
+        (ConvertThroughFiles('h', NULL, "0x12", 4, output, &outputLen) == 0) ||
+        (ConvertThroughFiles('h', NULL, "12_3", 4, output, &outputLen) == 0) ||
+        (ConvertThroughFiles('b', NULL, "1012", 4, output, &outputLen) == 0) ||
+        (ConvertThroughFiles('d', NULL, "1", 1, output, &outputLen) == 0)) {
+        ReportFailure("stream", "invalid stream", "accepted", "rejected");
+    }
+
+    for (i = 0; i < STREAM_CASE_COUNT; i++) {
+        /* A random Binary digit count, not always a multiple of 4. */
+        digitCount = 1u + (Random() % (STREAM_CASE_DIGITS_MAX * 4u));
+        if ((i % 2u) == 0) {
+            digitCount = (digitCount + 3u) & ~(size_t)3u;
+        }
+
+        binaryLen = 0;
+        for (j = 0; j < digitCount; j++) {
+            binary[binaryLen++] = (char)('0' + (Random() & 1u));
+        }
+
+        /* Reference: pad with leading zeros and convert per nibble with strtoul(). */
+        hexLen = 0;
+        value = 0;
+        k = (4u - (digitCount % 4u)) % 4u;
+        for (j = 0; j < digitCount; j++) {
+            value = (value << 1) | (unsigned long)(binary[j] - '0');
+            k++;
+            if (k == 4u) {
+                hex[hexLen++] = "0123456789abcdef"[value];
+                value = 0;
+                k = 0;
+            }
+        }
+
+        /* Binary to Hexadecimal, with whitespace between the digits. */
+        len = 0;
+        for (j = 0; j < binaryLen; j++) {
+            if ((Random() % 64u) == 0) {
+                input[len++] = whitespace[Random() % 4u];
+            }
+            input[len++] = binary[j];
+        }
+        if ((ConvertThroughFiles('b', NULL, input, len, output, &outputLen) != 0) ||
+            (outputLen != (hexLen + 1u)) || (memcmp(output, hex, hexLen) != 0) ||
+            (output[hexLen] != '\n')) {
+            ReportFailure("stream", "<binary>", "<hexadecimal>", "<hexadecimal>");
+        }
+
+        /* Hexadecimal to Binary, in mixed case and with separators between the digits. */
+        len = 0;
+        for (j = 0; j < hexLen; j++) {
+            if ((Random() % 32u) == 0) {
+                input[len++] = SEPARATORS[Random() % (sizeof(SEPARATORS) - 1u)];
+            }
+            input[len++] = ((Random() % 2u) == 0) ? (char)toupper(hex[j]) : hex[j];
+        }
+        for (j = 0; j < hexLen; j++) {
+            digit[0] = hex[j];
+            value = strtoul(digit, NULL, 16);
+            for (k = 0; k < 4u; k++) {
+                binary[(j * 4u) + k] = (char)('0' + ((value >> (3u - k)) & 1u));
+            }
+        }
+        if ((ConvertThroughFiles('h', SEPARATORS, input, len, output, &outputLen) != 0) ||
+            (outputLen != ((hexLen * 4u) + 1u)) || (memcmp(output, binary, hexLen * 4u) != 0) ||
+            (output[hexLen * 4u] != '\n')) {
+            ReportFailure("stream", "<hexadecimal>", "<binary>", "<binary>");
+        }
+    }
+
+    return STREAM_CASE_COUNT;
+}
+
+/*!
+ * \brief Check layout compilation and compare field decoding against shifting per field.
+ * \returns
+ *      The number of executed cases.
+ */
+static uint64_t RunLayoutCases(void)
+{
+    static Layout layout;
+    static const char text[] =
+        "# Control register\n"
+        "ENABLE 0 0=off,1=on\r\n"
+        "\n"
+        "  MODE\t3:1   0=idle,2=sleep\n"
+        "COUNT 15:8\n"
+        "TOP 0x3f:32";
+    static const char expected[] =
+        "Fields:\n"
+        "  ENABLE[0] = 1 (on)\n"
+        "  MODE[3:1] = 2 (sleep)\n"
+        "  COUNT[15:8] = 18\n"
+        "  TOP[63:32] = 4660\n"
+        "\n";
+    static const char *invalidTexts[] = {
+        "A", "A 1:2", "A 64", "A 0:-1", "1A 0", "A 0 x", "A 1:0 0=a,0=b", "A 1:0 4=a",
+        "A 1:0 1=", "A 0 1=a=b", "A 0 0=a 1=b", "A 0 0=aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    };
+    char output[LAYOUT_LINE_FORMAT_SIZE];
+    char reference[LAYOUT_LINE_FORMAT_SIZE];
+    char line[LAYOUT_LINE_SIZE_MAX];
+    FILE *in = NULL;
+    FILE *out = NULL;
+    uint64_t number = 0;
+    uint64_t value = 0;
+    uint64_t i = 0;
+    uint32_t msb = 0;
+    uint32_t lsb = 0;
+    uint32_t fieldCount = 0;
+    uint32_t j = 0;
+    size_t textLen = 0;
+    size_t len = 0;
+    size_t referenceLen = 0;
+
+    if ((CompileLayout(text, sizeof(text) - 1u, &layout) != 0) ||
+        (FormatFields(&layout, 0x123400001205u, output) != (sizeof(expected) - 1u)) ||
+        (strcmp(output, expected) != 0)) {
+        ReportFailure("layout", "0x123400001205", output, expected);
+    }
+
+    len = FormatFieldsLine(&layout, 0x3u, output);
+    output[len] = '\0';
+    if (strcmp(output, " ENABLE=on MODE=1 COUNT=0 TOP=0\n") != 0) {
+        ReportFailure("layout", "0x3", output, " ENABLE=on MODE=1 COUNT=0 TOP=0");
+    }
+
+    for (j = 0; j < (sizeof(invalidTexts) / sizeof(invalidTexts[0])); j++) {
+        if (CompileLayout(invalidTexts[j], strlen(invalidTexts[j]), &layout) != 1) {
+            ReportFailure("layout", invalidTexts[j], "accepted", "rejected");
+        }
+    }
+    if (CompileLayout("A 0\n\nB 2:1:0", 13, &layout) != 3) {
+        ReportFailure("layout", "A 0\\n\\nB 2:1:0", "", "line 3");
+    }
+
+    /* Batch decoding, an invalid value is reported and the others are still decoded. */
+    (void)CompileLayout(text, sizeof(text) - 1u, &layout);
+    in = tmpfile();
+    out = tmpfile();
+    if ((in != NULL) && (out != NULL)) {
+        fputs("0x5\t1_0b\n12g\n", in);
+        rewind(in);
+        if (DecodeStream(&layout, "_", in, out) == 0) {
+            ReportFailure("layout", "batch 12g", "accepted", "rejected");
+        }
+        rewind(out);
+        len = fread(output, 1, sizeof(output) - 1u, out);
+        output[len] = '\0';
+        if (strcmp(output, "0x5 ENABLE=on MODE=sleep COUNT=0 TOP=0\n"
+                           "1_0b ENABLE=off MODE=1 COUNT=0 TOP=0\n"
+                           "12g invalid\n") != 0) {
+            ReportFailure("layout", "batch", output, "<lines>");
+        }
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+
+    for (i = 0; i < LAYOUT_CASE_COUNT; i++) {
+        /* A random layout without labels. */
+        fieldCount = 1u + (uint32_t)(Random() % 8u);
+        textLen = 0;
+        for (j = 0; j < fieldCount; j++) {
+            lsb = (uint32_t)(Random() % 64u);
+            msb = lsb + (uint32_t)(Random() % (64u - lsb));
+            textLen += (size_t)snprintf(&line[textLen], sizeof(line) - textLen, "F%u %u:%u\n",
+                                        (unsigned)j, (unsigned)msb, (unsigned)lsb);
+        }
+        if (CompileLayout(line, textLen, &layout) != 0) {
+            ReportFailure("layout", line, "rejected", "accepted");
+            continue;
+        }
+
+        number = RandomNumber();
+        len = FormatFieldsLine(&layout, number, output);
+
+        referenceLen = 0;
+        textLen = 0;
+        for (j = 0; j < fieldCount; j++) {
+            (void)sscanf(&line[textLen], "F%*u %u:%u", &msb, &lsb);
+            while (line[textLen++] != '\n') {
+            }
+            value = number >> lsb;
+            if ((msb - lsb) < 63u) {
+                value &= (UINT64_C(1) << (msb - lsb + 1u)) - 1u;
+            }
+            referenceLen += (size_t)snprintf(&reference[referenceLen],
+                                             sizeof(reference) - referenceLen, " F%u=%llu",
+                                             (unsigned)j, (unsigned long long)value);
+        }
+        reference[referenceLen++] = '\n';
+
+        if ((len != referenceLen) || (memcmp(output, reference, len) != 0)) {
+            ReportFailure("layout", line, "<fields>", "<fields>");
+        }
+    }
+
+    return LAYOUT_CASE_COUNT;
+}
+
+/*!
+ * \brief This is the program entry.
+ * \details
+ *      Run the numconvert conformance tests in-process: the golden-file cases, the table-driven
+ *      cases and randomly generated cases. The latter two are checked against a reference model
+ *      built on strtoull() and snprintf(). Half of the random cases have digit separators inserted.
+ *
+ *      Optional arguments:
+ *          argv[1] is the number of random cases, f.e. "10000000"
+ *          argv[2] is the random seed, f.e. "42"
+ *
+ *      Alternatively "--binary <numconvert>" runs the golden-file cases and the option
+ *      combinations end-to-end against the numconvert executable instead.
+ *
+ *      Must be executed from the test/functional directory for the golden files to be found.
+ * \param argc
+ *      The number of string pointed to by argv (argument count).
+ * \param argv
+ *      A list of strings (argument vector).
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int main(int argc, char *argv[])
+{
+    uint64_t randomCount = RANDOM_CASE_COUNT_DEFAULT;
+    uint64_t tableCount = 0;
+    uint64_t seed = RandomState;
+    clock_t start = 0;
+    double seconds = 0.0;
+    int exitCode = 0;
+
+    if ((argc == 3) && (strcmp(argv[1], "--binary") == 0)) {
+        return RunCommandCases(argv[2]);
+    }
+
+    if (argc > 3) {
+        printf("argument mismatch\n");
+        return -1;
+    }
+    if (argc >= 2) {
+        randomCount = strtoull(argv[1], NULL, 10);
+    }
+    if (argc == 3) {
+        seed = strtoull(argv[2], NULL, 0);
+        if (seed == 0) {
+            /* xorshift cannot leave the all zeros state. */
+            seed = 1;
+        }
+    }
+    RandomState = seed;
+
+    exitCode = RunGoldenCases();
+
+    start = clock();
+    tableCount = RunTableCases();
+    tableCount += RunRangeCases();
+    tableCount += RunStreamCases();
+    tableCount += RunLayoutCases();
+    if (FailureCount != 0) {
+        printf("Table cases:%u of %llu failed\n", FailureCount, (unsigned long long)tableCount);
+        return CONVERSION_FAILURE_CODE;
+    }
+    printf("Table cases:%llu successful\n", (unsigned long long)tableCount);
+
+    RunRandomCases(randomCount);
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (FailureCount != 0) {
+        printf("Random cases:%u of %llu failed (seed %llu)\n", FailureCount,
+               (unsigned long long)randomCount, (unsigned long long)seed);
+        return CONVERSION_FAILURE_CODE;
+    }
+    printf("Random cases:%llu successful (seed %llu, %.1f s)\n", (unsigned long long)randomCount,
+           (unsigned long long)seed, seconds);
+
+    return exitCode;
 }
@@ -0,0 +1,102 @@
+#!/bin/bash
+# This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+# Copyright (c) 2019 Bas Kapteijn.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, version 3.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+# Prerequisites
+# For libfuzzer: install clang (f.e. for Ubuntu use "sudo apt-get install clang")
+# For afl: install AFL++ (f.e. for Ubuntu use "sudo apt-get install afl++")
+#
+# Usage: ./fuzz.sh [replay|libfuzzer|afl] [seconds]
+#   replay     replay the corpus through the fuzz target with gcc, the default
+#   libfuzzer  fuzz in-process with libFuzzer for the given number of seconds (default 60)
+#   afl        fuzz persistently with AFL++ for the given number of seconds (default 60)
+
+exit_on_error()
+{
+    arg1=$1
+
+    echo "Failed to execute with error "$arg1". Exiting..."
+    exit $arg1
+}
+
+MODE="${1:-replay}"
+DURATION="${2:-60}"
+SOURCES="fuzz_convert.c scalar.c ../../src/numconvert.c ../../src/range.c ../../src/stream.c"
+
+# Build the seed corpus from the functional test inputs
+{
+    mkdir -p corpus
+    sed -n 's/^    { "\([0-9]*\)", "\(.*\)", [0-9]*, "stdout.*/\1|\2/p' ../functional/main.c |
+    while IFS='|' read -r name input; do
+        printf '%s' "${input//\\\"/\"}" > corpus/functional_$name
+    done
+    # Table inputs may hold any character, so the files are numbered instead
+    index=0
+    sed -n 's/^    { "\([^"]*\)", \(true\|false\), .*/\1/p' ../functional/main.c |
+    while IFS= read -r input; do
+        printf '%s' "$input" > corpus/table_$index
+        index=$((index + 1))
+    done
+    # Long digit runs for the streaming conversion
+    printf '%0128d' 0 | tr 0 1 > corpus/stream_binary
+    printf '0123456789abcdefABCDEF_%.0s' {1..8} > corpus/stream_hexadecimal
+} &> /dev/null
+rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+
+case "$MODE" in
+    replay)
+        {
+            gcc -Wall -O2 -g -I../../src $SOURCES -pthread -o fuzz_replay
+        } &> /dev/null
+        rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+
+        # Replay the seeds and whatever earlier fuzzing runs found
+        INPUTS="corpus"
+        for dir in findings/default/queue findings/default/crashes; do
+            if [[ -d $dir ]]; then INPUTS="$INPUTS $dir"; fi
+        done
+        ./fuzz_replay $INPUTS
+        rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+        ;;
+    libfuzzer)
+        {
+            clang -O2 -g -fsanitize=fuzzer,address,undefined -DFUZZ_WITH_LIBFUZZER -I../../src \
+                  $SOURCES -pthread -o fuzz_libfuzzer
+        } &> /dev/null
+        rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+
+        # New interesting inputs are added to findings/default/queue, the seeds stay untouched
+        mkdir -p findings/default/queue
+        ./fuzz_libfuzzer -max_total_time=$DURATION -max_len=128 -artifact_prefix=findings/ \
+                         findings/default/queue corpus
+        rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+        ;;
+    afl)
+        {
+            afl-clang-fast -O2 -g -I../../src $SOURCES -pthread -o fuzz_afl
+        } &> /dev/null
+        rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+
+        afl-fuzz -V $DURATION -i corpus -o findings -- ./fuzz_afl
+        rc=$?; if [[ $rc != 0 ]]; then exit_on_error $rc; fi
+        ;;
+    *)
+        exit_on_error 1
+        ;;
+esac
+
+echo "Script completed."
+
+exit 0
@@ -0,0 +1,545 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _POSIX_C_SOURCE 200809L /* fmemopen() and open_memstream(). */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include "numconvert.h"
+#include "range.h"
+#include "stream.h"
+#include "scalar.h"
+
+#define ARGUMENT_SIZE_MAX   128u /* Anything beyond BUFFER_SIZE is rejected by length alone. */
+#define INPUT_SIZE_MAX      4096u
+#define SEPARATORS          "_', "
+#define RANGE_INPUT_SIZE    26u  /* The number, start and step (8 bytes each), count and flags. */
+#define RANGE_COUNT_MAX     256u /* Enough to carry through every digit of small numbers. */
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/*!
+ * \brief Report a difference between the optimized and the scalar implementation and abort.
+ * \details
+ *      Aborting is what makes libFuzzer and AFL store the input as a crash.
+ * \param kind
+ *      The kind of difference, f.e. "parse".
+ * \param input
+ *      The input that caused the difference.
+ * \param output
+ *      The output of the optimized implementation.
+ * \param expected
+ *      The output of the scalar implementation.
+ */
+static void Fail(const char *kind, const char *input, const char *output, const char *expected)
+{
+    fprintf(stderr, "%s mismatch for \"%s\"\n", kind, input);
+    fprintf(stderr, "  output:          %s\n", output);
+    fprintf(stderr, "  expected output: %s\n", expected);
+
+    abort();
+}
+
+/*!
+ * \brief Differentially check the conversion of a command line argument.
+ * \param argument
+ *      The command line argument.
+ * \param len
+ *      The length of the argument (excluding the string terminator).
+ */
+static void CheckArgument(const char *argument, size_t len)
+{
+    char output[OUTPUT_BUFFER_SIZE];
+    char expected[SCALAR_OUTPUT_SIZE];
+    uint64_t number = 0;
+    uint64_t scalarNumber = 0;
+    int retval = 0;
+    int scalarRetval = 0;
+
+    retval = ConvertString(argument, len, &number);
+    scalarRetval = ScalarConvertString(argument, len, &scalarNumber);
+
+    if (retval != scalarRetval) {
+        Fail("parse", argument, (retval == 0) ? "accepted" : "rejected",
+             (scalarRetval == 0) ? "accepted" : "rejected");
+    }
+
+    if (retval == 0) {
+        (void)FormatNumerals(number, output);
+        (void)ScalarFormatNumerals(scalarNumber, expected);
+        if (strcmp(output, expected) != 0) {
+            Fail("numerals", argument, output, expected);
+        }
+    }
+}
+
+/*!
+ * \brief Check that every separator has a digit on both sides.
+ * \details
+ *      A digit is a Hexadecimal character that is not part of the 0x prefix or the b/h postfix,
+ *      consecutive separators are skipped to find the neighbours.
+ * \param argument
+ *      The command line argument.
+ * \param len
+ *      The length of the argument (excluding the string terminator).
+ * \returns
+ *      true if all separators are between digits, otherwise false.
+ */
+static bool SeparatorsValid(const char *argument, size_t len)
+{
+    size_t first = 0;
+    size_t last = len;
+    size_t before = 0;
+    size_t after = 0;
+    size_t i = 0;
+
+    if ((len >= 2u) && (argument[0] == '0') && ((argument[1] | 0x20) == 'x')) {
+        first = 2u;
+    } else if ((len >= 1u) && (((argument[len - 1u] | 0x20) == 'b') ||
+                               ((argument[len - 1u] | 0x20) == 'h'))) {
+        last = len - 1u;
+    }
+
+    for (i = 0; i < len; i++) {
+        if (strchr(SEPARATORS, argument[i]) == NULL) {
+            continue;
+        }
+
+        for (before = i; (before > 0) && (strchr(SEPARATORS, argument[before - 1u]) != NULL);
+             before--) {
+        }
+        for (after = i + 1u; (after < len) && (strchr(SEPARATORS, argument[after]) != NULL);
+             after++) {
+        }
+        if ((before == 0) || (after == len) || ((before - 1u) < first) || (after >= last) ||
+            (isxdigit((unsigned char)argument[before - 1u]) == 0) ||
+            (isxdigit((unsigned char)argument[after]) == 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Differentially check the conversion of a command line argument with digit separators.
+ * \details
+ *      The separator positions are checked and the separators are removed per character before
+ *      the scalar conversion.
+ * \param argument
+ *      The command line argument.
+ * \param len
+ *      The length of the argument (excluding the string terminator).
+ */
+static void CheckSeparatedArgument(const char *argument, size_t len)
+{
+    char stripped[ARGUMENT_SIZE_MAX];
+    uint64_t number = 0;
+    uint64_t scalarNumber = 0;
+    size_t strippedLen = 0;
+    size_t i = 0;
+    int retval = 0;
+    int scalarRetval = -1;
+
+    for (i = 0; i < len; i++) {
+        if (strchr(SEPARATORS, argument[i]) == NULL) {
+            stripped[strippedLen++] = argument[i];
+        }
+    }
+    stripped[strippedLen] = '\0';
+
+    retval = ConvertSeparatedString(argument, len, SEPARATORS, &number);
+    if (SeparatorsValid(argument, len) == true) {
+        scalarRetval = ScalarConvertString(stripped, strippedLen, &scalarNumber);
+    }
+
+    if ((retval != scalarRetval) || ((retval == 0) && (number != scalarNumber))) {
+        Fail("separated parse", argument, (retval == 0) ? "accepted" : "rejected",
+             (scalarRetval == 0) ? "accepted" : "rejected");
+    }
+}
+
+/*!
+ * \brief Differentially check the formatting of a number and parse every format back.
+ * \param number
+ *      The number to check.
+ */
+static void CheckNumber(uint64_t number)
+{
+    char output[OUTPUT_BUFFER_SIZE];
+    char expected[SCALAR_OUTPUT_SIZE];
+    char binary[BINARY_FORMAT_SIZE];
+    size_t len = 0;
+    size_t i = 0;
+    uint64_t parsed = 0;
+
+    (void)FormatNumerals(number, output);
+    (void)ScalarFormatNumerals(number, expected);
+    if (strcmp(output, expected) != 0) {
+        Fail("numerals", "<number>", output, expected);
+    }
+
+    /* Decimal and Hexadecimal formats are valid input as they are. */
+    len = FormatDecimal(number, output);
+    if ((ConvertString(output, len, &parsed) != 0) || (parsed != number)) {
+        Fail("decimal round-trip", output, "", "");
+    }
+
+    len = FormatHexadecimal(number, output);
+    if ((ConvertString(output, len, &parsed) != 0) || (parsed != number)) {
+        Fail("hexadecimal round-trip", output, "", "");
+    }
+
+    /* The Binary format needs its grouping removed and the postfix added. */
+    (void)FormatBinary(number, binary);
+    for (i = 0, len = 0; binary[i] != '\0'; i++) {
+        if (binary[i] != ' ') {
+            output[len++] = binary[i];
+        }
+    }
+    output[len++] = 'b';
+    output[len] = '\0';
+    if ((ConvertString(output, len, &parsed) != 0) || (parsed != number)) {
+        Fail("binary round-trip", output, "", "");
+    }
+}
+
+/*!
+ * \brief Read a little-endian 64-bit value from the fuzz input.
+ * \param data
+ *      The first of 8 bytes.
+ * \returns
+ *      The value.
+ */
+static uint64_t ReadValue(const uint8_t *data)
+{
+    uint64_t value = 0;
+    size_t i = 0;
+
+    for (i = 0; i < sizeof(value); i++) {
+        value |= (uint64_t)data[i] << (i * 8u);
+    }
+
+    return value;
+}
+
+/*!
+ * \brief Differentially check the in-place formatting of a block of range values.
+ * \param start
+ *      The first value of the range.
+ * \param step
+ *      The step of the range, at least 1.
+ * \param first
+ *      The index of the first value to format.
+ * \param count
+ *      The number of values to format, at least 1.
+ */
+static void CheckRange(uint64_t start, uint64_t step, uint64_t first, uint64_t count)
+{
+    static char output[(RANGE_COUNT_MAX * RANGE_LINE_SIZE_MAX) + RANGE_BLOCK_SLACK];
+    static char expected[RANGE_COUNT_MAX * RANGE_LINE_SIZE_MAX];
+    char input[64];
+    uint64_t maxIndex = 0;
+    size_t len = 0;
+    size_t expectedLen = 0;
+    Range range;
+
+    /* The last value must not exceed UINT64_MAX. */
+    maxIndex = (UINT64_MAX - start) / step;
+    if (first > maxIndex) {
+        first = maxIndex;
+    }
+    if (count > (maxIndex - first + 1u)) {
+        count = maxIndex - first + 1u;
+    }
+
+    range.start = start;
+    range.step = step;
+    range.count = first + count;
+    range.end = start + ((first + count - 1u) * step) + 1u;
+
+    len = FormatRangeBlock(&range, first, count, output);
+    expectedLen = ScalarFormatRange(start, step, first, count, expected);
+
+    if ((len != expectedLen) || (memcmp(output, expected, len) != 0)) {
+        snprintf(input, sizeof(input), "%llu:+%llu[%llu]", (unsigned long long)start,
+                 (unsigned long long)step, (unsigned long long)first);
+        output[len] = '\0';
+        expected[expectedLen] = '\0';
+        Fail("range", input, output, expected);
+    }
+}
+
+/*!
+ * \brief Differentially check the streaming conversion of some input.
+ * \param base
+ *      The input base, 'b' or 'h'.
+ * \param input
+ *      The input characters.
+ * \param len
+ *      The number of input characters.
+ */
+static void CheckStream(char base, const char *input, size_t len)
+{
+    static char expected[(INPUT_SIZE_MAX * 4u) + 1u];
+    char *output = NULL;
+    size_t outputLen = 0;
+    size_t expectedLen = 0;
+    int retval = -1;
+    int scalarRetval = 0;
+    FILE *in = NULL;
+    FILE *out = NULL;
+
+    /* A memory stream is seekable, so Binary input is padded like a regular file. */
+    in = fmemopen((void *)input, (len > 0) ? len : 1u, "r");
+    out = open_memstream(&output, &outputLen);
+    if ((in != NULL) && (out != NULL)) {
+        retval = (len > 0) ? ConvertStream(base, SEPARATORS, in, out) : -1;
+    }
+    if (in != NULL) {
+        (void)fclose(in);
+    }
+    if (out != NULL) {
+        (void)fclose(out);
+    }
+
+    scalarRetval = ScalarConvertStream(base, SEPARATORS, input, len, expected, &expectedLen);
+
+    if (retval != scalarRetval) {
+        Fail((base == 'h') ? "hex2bin" : "bin2hex", "<stream>",
+             (retval == 0) ? "accepted" : "rejected", (scalarRetval == 0) ? "accepted" : "rejected");
+    }
+
+    if ((retval == 0) &&
+        ((outputLen != expectedLen) || (memcmp(output, expected, outputLen) != 0))) {
+        expected[expectedLen] = '\0';
+        Fail((base == 'h') ? "hex2bin" : "bin2hex", "<stream>", output, expected);
+    }
+
+    free(output);
+}
+
+/*!
+ * \brief Differentially check the streaming conversion of the fuzz input.
+ * \details
+ *      The input is converted as it is and mapped to digits and separators, as random bytes rarely
+ *      form the long digit runs that are converted 16 characters at a time.
+ * \param data
+ *      The fuzz input.
+ * \param size
+ *      The number of bytes in data.
+ */
+static void CheckStreams(const uint8_t *data, size_t size)
+{
+    static const char Digits[] = "0123456789abcdefABCDEF";
+    static const char Skipped[] = " _\n'";
+    static char mapped[2][INPUT_SIZE_MAX];
+    size_t i = 0;
+
+    CheckStream('h', (const char *)data, size);
+    CheckStream('b', (const char *)data, size);
+
+    for (i = 0; i < size; i++) {
+        if ((data[i] & 0xe0u) == 0) {
+            mapped[0][i] = Skipped[data[i] % (sizeof(Skipped) - 1u)];
+            mapped[1][i] = mapped[0][i];
+        } else {
+            mapped[0][i] = Digits[data[i] % (sizeof(Digits) - 1u)];
+            mapped[1][i] = (char)('0' + (data[i] & 1u));
+        }
+    }
+
+    CheckStream('h', mapped[0], size);
+    CheckStream('b', mapped[1], size);
+}
+
+/*!
+ * \brief The fuzz target.
+ * \details
+ *      The input up to the first NUL character is a command line argument (which cannot hold a
+ *      NUL character). The first 8 bytes are also used as a number to format and the next 18
+ *      bytes as a range block to format. The whole input is also converted as a stream.
+ *
+ *      Inputs are cut at INPUT_SIZE_MAX bytes, AFL++ persistent mode passes any length.
+ * \param data
+ *      The fuzz input.
+ * \param size
+ *      The number of bytes in data.
+ * \returns
+ *      0, always.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    char argument[ARGUMENT_SIZE_MAX];
+    uint64_t step = 0;
+    size_t len = 0;
+
+    if (size > INPUT_SIZE_MAX) {
+        size = INPUT_SIZE_MAX;
+    }
+
+    while ((len < size) && (len < (sizeof(argument) - 1u)) && (data[len] != '\0')) {
+        argument[len] = (char)data[len];
+        len++;
+    }
+    argument[len] = '\0';
+
+    CheckArgument(argument, len);
+    CheckSeparatedArgument(argument, len);
+
+    if (size >= sizeof(uint64_t)) {
+        CheckNumber(ReadValue(data));
+    }
+
+    if (size >= RANGE_INPUT_SIZE) {
+        /* Small steps carry through the digit strings most often. */
+        step = ReadValue(&data[16]);
+        if ((data[25] & 0x80u) != 0) {
+            step &= 0xffu;
+        }
+        CheckRange(ReadValue(&data[8]), (step == 0) ? 1u : step, data[25] & 0x03u,
+                   (uint64_t)(data[24] % RANGE_COUNT_MAX) + 1u);
+    }
+
+    CheckStreams(data, size);
+
+    return 0;
+}
+
+#ifndef FUZZ_WITH_LIBFUZZER
+
+#ifdef __AFL_FUZZ_TESTCASE_LEN
+__AFL_FUZZ_INIT();
+#endif
+
+/*!
+ * \brief Run the fuzz target once on the contents of a file.
+ * \param path
+ *      The file path.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int RunFile(const char *path)
+{
+    uint8_t data[INPUT_SIZE_MAX];
+    size_t size = 0;
+    FILE *fp = NULL;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        printf("unable to open %s\n", path);
+        return -1;
+    }
+    size = fread(data, 1, sizeof(data), fp);
+    (void)fclose(fp);
+
+    return LLVMFuzzerTestOneInput(data, size);
+}
+
+/*!
+ * \brief Run the fuzz target once on every file in a directory.
+ * \param path
+ *      The directory path.
+ * \param[out] count
+ *      Incremented for every executed file.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int RunDirectory(const char *path, uint32_t *count)
+{
+    char filePath[INPUT_SIZE_MAX];
+    struct dirent *entry = NULL;
+    DIR *dir = NULL;
+    int retval = 0;
+
+    dir = opendir(path);
+    if (dir == NULL) {
+        return RunFile(path);
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(filePath, sizeof(filePath), "%s/%s", path, entry->d_name);
+        retval = RunFile(filePath);
+        if (retval != 0) {
+            break;
+        }
+        (*count)++;
+    }
+    (void)closedir(dir);
+
+    return retval;
+}
+
+/*!
+ * \brief This is the program entry for builds without libFuzzer.
+ * \details
+ *      With AFL++ (afl-clang-fast) the target runs persistently on shared-memory test cases.
+ *      Otherwise every argument is a file or corpus directory to replay, or stdin is used when
+ *      there are no arguments.
+ * \param argc
+ *      The number of string pointed to by argv (argument count).
+ * \param argv
+ *      A list of strings (argument vector).
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int main(int argc, char *argv[])
+{
+    uint8_t data[INPUT_SIZE_MAX];
+    uint32_t count = 0;
+    int retval = 0;
+    int i = 0;
+
+#ifdef __AFL_FUZZ_TESTCASE_LEN
+    uint8_t *buf = NULL;
+
+    (void)argc;
+    (void)argv;
+    (void)data;
+    (void)count;
+    (void)i;
+
+    __AFL_INIT();
+    buf = __AFL_FUZZ_TESTCASE_BUF;
+    while (__AFL_LOOP(100000)) {
+        retval = LLVMFuzzerTestOneInput(buf, (size_t)__AFL_FUZZ_TESTCASE_LEN);
+    }
+#else
+    if (argc == 1) {
+        retval = LLVMFuzzerTestOneInput(data, fread(data, 1, sizeof(data), stdin));
+        count++;
+    }
+
+    for (i = 1; (i < argc) && (retval == 0); i++) {
+        retval = RunDirectory(argv[i], &count);
+    }
+
+    printf("Replayed %u inputs\n", count);
+#endif
+
+    return retval;
+}
+
+#endif /* FUZZ_WITH_LIBFUZZER */
@@ -0,0 +1,704 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*!
+ * \file
+ * \brief The original scalar check, parse and print routines of numconvert.
+ * \details
+ *      Kept verbatim, except for printing into a buffer instead of to the console, as the
+ *      reference that the optimized implementations in src/ are differentially fuzzed against.
+ *
+ *      ScalarFormatRange() and ScalarConvertStream() are straightforward per value and per digit
+ *      references for the range generator and the streaming conversion, which have no original.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include "scalar.h"
+
+#define BINARY_STRING_LEN_MAX           65u
+#define DECIMAL_STRING_LEN_MAX          20u
+#define HEXADECIMAL_H_STRING_LEN_MAX    17u
+#define HEXADECIMAL_0X_STRING_LEN_MAX   18u
+#define BUFFER_SIZE                     (BINARY_STRING_LEN_MAX + 1u) /* + string terminator. */
+
+/* UINT64_MAX equivalent string. */
+static const char *DecimalStringValueMax = "18446744073709551615";
+
+/* The console replacement, see OutputChar() and OutputPrintf(). */
+static char *Output = NULL;
+static size_t OutputLen = 0;
+
+static void OutputChar(char c);
+static void OutputPrintf(const char *format, ...);
+
+static bool IsBinaryChar(char c);
+static bool IsDecimalChar(char c);
+static bool IsHexadecimalChar(char c);
+static void PrintBinary(uint64_t number);
+static void PrintDecimal(uint64_t number);
+static void PrintHexadecimal(uint64_t number);
+static void ParseBinary(const char *string, size_t len, uint64_t *number);
+static void ParseDecimal(const char *string, size_t len, uint64_t *number);
+static void ParseHexadecimal(const char *string, size_t len, uint64_t *number);
+static bool IsBinary(const char *string, size_t len);
+static bool IsDecimal(const char *string, size_t len);
+static bool IsHexadecimal(const char *string, size_t len);
+static void PrintNumerals(uint64_t number);
+static void ParseString(const char *string, size_t len, uint64_t *number, char base);
+static int CheckString(const char *string, size_t len, char *base);
+
+/*!
+ * \brief Convert a character to it's lowercase equivalent (when required).
+ * \param c
+ *      The character to convert.
+ * \returns
+ *      The lowercase equivalent of c or c when no conversion was required.
+ */
+static char ToLower(char c)
+{
+    if ((c >= 'A') && (c <= 'Z')) {
+        c = (char)(c + 0x20);
+    }
+
+    return c;
+}
+
+/*!
+ * \brief Indicate if a character represents a valid Binary character.
+ * \param c
+ *      The character to verify.
+ * \returns
+ *      true if the character represents a valid Binary character, otherwise false.
+ */
+static bool IsBinaryChar(char c)
+{
+    bool isBinaryChar = false;
+
+    if ((c == '0') || (c == '1')) {
+        isBinaryChar = true;
+    }
+
+    return isBinaryChar;
+}
+
+/*!
+ * \brief Indicate if a character represents a valid Decimal character.
+ * \param c
+ *      The character to verify.
+ * \returns
+ *      true if the character represents a valid Decimal character, otherwise false.
+ */
+static bool IsDecimalChar(char c)
+{
+    bool isDecimalChar = false;
+
+    if ((c >= '0') && (c <= '9')) {
+        isDecimalChar = true;
+    }
+
+    return isDecimalChar;
+}
+
+/*!
+ * \brief Indicate if a character represents a valid Hexadecimal character.
+ * \param c
+ *      The character to verify.
+ * \returns
+ *      true if the character represents a valid Hexadecimal character, otherwise false.
+ */
+static bool IsHexadecimalChar(char c)
+{
+    bool isHexaDecimalChar = false;
+
+    if ((IsDecimalChar(c) == true) ||
+        ((c >= 'a') && (c <= 'f'))) {
+        isHexaDecimalChar = true;
+    }
+
+    return isHexaDecimalChar;
+}
+
+/*!
+ * \brief Print a number in Binary format to the console.
+ * \param number
+ *      The number to print.
+ */
+static void PrintBinary(uint64_t number)
+{
+    int64_t i = 0;
+
+    OutputPrintf("Binary:\n  ");
+
+    for (i = 63; i >= 0; i--) {
+        if (((number >> i) & 0x1) == 0x1) {
+            OutputChar('1');
+        } else {
+            OutputChar('0');
+        }
+
+        if (i % 4 == 0) {
+            OutputChar(' ');
+
+            if (i == 32) {
+                OutputChar('\n');
+                OutputChar(' ');
+                OutputChar(' ');
+            }
+        }
+    }
+
+    OutputChar('\n');
+}
+
+/*!
+ * \brief Print a number in Decimal format to the console.
+ * \param number
+ *      The number to print.
+ */
+static void PrintDecimal(uint64_t number)
+{
+    OutputPrintf("Decimal:\n");
+    OutputPrintf("  %llu\n", (unsigned long long)number);
+}
+
+/*!
+ * \brief Print a number in Hexadecimal format to the console.
+ * \param number
+ *      The number to print.
+ */
+static void PrintHexadecimal(uint64_t number)
+{
+    OutputPrintf("Hexadecimal:\n");
+    OutputPrintf("  0x%llx\n", (long long unsigned int)number);
+}
+
+/*!
+ * \brief Parse a string that represents a Binary value and returns its value.
+ * \param string
+ *      The string to parse.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string.
+ */
+static void ParseBinary(const char *string, size_t len, uint64_t *number)
+{
+    int64_t i = 0;
+
+    *number = 0;
+
+    for (i = ((int64_t)len - 1); i >= 0; i--) {
+        if (string[i] == '1') {
+            *number += (uint64_t)1 << (len - 2 - i);
+        }
+    }
+}
+
+/*!
+ * \brief Parse a string that represents a Decimal value and returns its value.
+ * \param string
+ *      The string to parse.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string.
+ */
+static void ParseDecimal(const char *string, size_t len, uint64_t *number)
+{
+    uint64_t val = 0;
+    int64_t i = 0;
+    uint64_t value = 0;
+
+    *number = 0;
+
+    val = 1;
+    for (i = ((int64_t)len - 1); i >= 0; i--) {
+        value = (string[i] - 0x30) * val;
+        *number += value;
+        val *= 10;
+    }
+}
+
+/*!
+ * \brief Parse a string that represents a Hexadecimal value and returns its value.
+ * \param string
+ *      The string to parse.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string.
+ */
+static void ParseHexadecimal(const char *string, size_t len, uint64_t *number)
+{
+    int64_t i = 0;
+    uint64_t value = 0;
+    uint64_t start = 0;
+    int64_t end = 0;
+
+    *number = 0;
+
+    if (string[len - 1] == 'h') {
+        start = len - 2;
+        end = 0;
+    } else { /* starts with 0x */
+        start = len - 1;
+        end = 2;
+    }
+
+    for (i = (int64_t)start; i >= end; i--) {
+        switch (string[i]) {
+            case 'a':
+            case 'b':
+            case 'c':
+            case 'd':
+            case 'e':
+                /* No break. */
+            case 'f':
+                value = (uint64_t)string[i] - 0x61 + 10;
+                break;
+            default:
+                value = (uint64_t)string[i] - 0x30;
+                break;
+        }
+        *number |= value << ((start - i) * 4);
+    }
+}
+
+/*!
+ * \brief Indicate if a string represents a valid Binary value.
+ * \param string
+ *      The string to verify.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \returns
+ *      true if the string represents a valid Binary value, otherwise false.
+ */
+static bool IsBinary(const char *string, size_t len)
+{
+    bool isBinary = false;
+    uint64_t i = 0;
+
+    if (string[len - 1] == 'b') {
+        isBinary = true;
+        for (i = 0; i < (len - 1); i++) {
+            if (IsBinaryChar(string[i]) == false) {
+                isBinary = false;
+                break;
+            }
+        }
+    }
+
+    if (isBinary == true) {
+        /* No need to check for maximum length:
+         * - (len >= BINARY_STRING_LEN_MAX + 1), or BUFFER_SIZE, is covered by main()
+         */
+        if (len < 2) {
+            /* This isn't gonna fit in UINT64_MAX. */
+            isBinary = false;
+        }
+    }
+
+    return isBinary;
+}
+
+/*!
+ * \brief Indicate if a string represents a valid Decimal value.
+ * \param string
+ *      The string to verify.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \returns
+ *      true if the string represents a valid Decimal value, otherwise false.
+ */
+static bool IsDecimal(const char *string, size_t len)
+{
+    bool isDecimal = true;
+    uint64_t i = 0;
+
+    for (i = 0; i < len; i++) {
+        if (IsDecimalChar(string[i]) == false) {
+            isDecimal = false;
+            break;
+        }
+    }
+
+    if (isDecimal == true) {
+        /* No need to check for minimum length:
+         * - (len == 0) is covered by CheckString()
+         */
+        if (len == DECIMAL_STRING_LEN_MAX) {
+            for (i = 0; i < DECIMAL_STRING_LEN_MAX; i++) {
+                if ((string[i] - 0x30) > (DecimalStringValueMax[i] - 0x30)) {
+                    /* This isn't gonna fit in UINT64_MAX. */
+                    isDecimal = false;
+                    break;
+                } else if ((string[i] - 0x30) == (DecimalStringValueMax[i] - 0x30)) {
+                    /* Continue checking the lower digits, it can still become too large. */
+                    continue;
+                } else {
+                    /* No need to continue checking the lower digits, it cannot become too large. */
+                    break;
+                }
+            }
+        } else if (len > DECIMAL_STRING_LEN_MAX) {
+            isDecimal = false;
+        }
+        /* else: will not happen because it's protected by CheckString(). */
+    }
+
+    return isDecimal;
+}
+
+/*!
+ * \brief Indicate if a string represents a valid Hexadecimal value.
+ * \param string
+ *      The string to verify.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \returns
+ *      true if the string represents a valid Hexadecimal value, otherwise false.
+ */
+static bool IsHexadecimal(const char *string, size_t len)
+{
+    bool isHexaDecimal = true;
+    uint64_t i = 0;
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t minLen = 0;
+    uint64_t maxLen = 0;
+
+    if (string[len - 1] == 'h') {
+        start = 0;
+        end = len - 1;
+        minLen = 2;
+        maxLen = HEXADECIMAL_H_STRING_LEN_MAX;
+    } else if ((string[0] == '0') && (string[1] == 'x')) {
+        start = 2;
+        end = len;
+        minLen = 3;
+        maxLen = HEXADECIMAL_0X_STRING_LEN_MAX;
+    } else {
+        isHexaDecimal = false;
+    }
+
+    if (isHexaDecimal == true) {
+        for (i = start; i < end; i++) {
+            if (IsHexadecimalChar(string[i]) == false) {
+                isHexaDecimal = false;
+                break;
+            }
+        }
+    }
+
+    if (isHexaDecimal == true) {
+        if ((len < minLen) ||
+            (len > maxLen)) {
+            /* This isn't gonna fit in UINT64_MAX. */
+            isHexaDecimal = false;
+        }
+    }
+
+    return isHexaDecimal;
+}
+
+/*!
+ * \brief Print a number to the console in Binary, Decimal and Hexadecimal.
+ * \param number
+ *      The number to print.
+ */
+static void PrintNumerals(uint64_t number)
+{
+    OutputChar('\n');
+
+    /* Decimal. */
+    PrintDecimal(number);
+
+    /* Binary. */
+    PrintBinary(number);
+
+    /* Hexadecimal. */
+    PrintHexadecimal(number);
+
+    OutputChar('\n');
+}
+
+/*!
+ * \brief Parse an input string and return it's represented value as a number.
+ * \param string
+ *      The input string to parse.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the numeric string in case it checked-out.
+ * \param base
+ *      The base of the numeric string.
+ */
+static void ParseString(const char *string, size_t len, uint64_t *number, const char base)
+{
+    if (base == 'd') {
+        ParseDecimal(string, len, number);
+    } else if (base == 'h') {
+        ParseHexadecimal(string, len, number);
+    } else {
+        /* base == 'b' is the only one left.
+         * Nothing else will happen because it's protected by CheckString().
+         */
+        ParseBinary(string, len, number);
+    }
+}
+
+/*!
+ * \brief Check an input string to be an expected numeric string.
+ * \param string
+ *      The input string to check.
+ * \param len
+ *      The length of the input string (excluding the string terminator).
+ * \param[out] base
+ *      The base of the numeric string in case it checked-out.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+static int CheckString(const char *string, size_t len, char *base)
+{
+    /* Is the len okay? */
+    if (len == 0) {
+        return -1;
+    }
+
+    /* Is Binary? */
+    if (IsBinary(string, len) == true) {
+        *base = 'b';
+        return 0;
+    }
+
+    /* Is Decimal? */
+    if (IsDecimal(string, len) == true) {
+        *base = 'd';
+        return 0;
+    }
+
+    /* Is Hexadecimal? */
+    if (IsHexadecimal(string, len) == true) {
+        *base = 'h';
+        return 0;
+    }
+
+    /* Is none of the above. */
+    return -1;
+}
+
+/*!
+ * \brief Append a character to the output buffer.
+ * \param c
+ *      The character to append.
+ */
+static void OutputChar(char c)
+{
+    Output[OutputLen++] = c;
+}
+
+/*!
+ * \brief Append formatted text to the output buffer.
+ * \param format
+ *      The printf() format string.
+ */
+static void OutputPrintf(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    OutputLen += (size_t)vsnprintf(&Output[OutputLen], SCALAR_OUTPUT_SIZE - OutputLen, format, args);
+    va_end(args);
+}
+
+/*!
+ * \brief Convert a command line argument the way the original main() did.
+ * \param argument
+ *      The command line argument.
+ * \param len
+ *      The length of the argument (excluding the string terminator).
+ * \param[out] number
+ *      The number represented by the argument in case it checked-out.
+ * \returns
+ *      0 in case of successful completion or any other value in case of an error.
+ */
+int ScalarConvertString(const char *argument, size_t len, uint64_t *number)
+{
+    char base = '\0';
+    char string[BUFFER_SIZE];
+    int retval = 0;
+    uint64_t i = 0;
+
+    if (len >= sizeof(string)) {
+        return -1;
+    }
+
+    memset(string, 0, sizeof(string));
+    for (i = 0; i < len; i++) {
+        string[i] = ToLower(argument[i]);
+    }
+
+    retval = CheckString(string, len, &base);
+    if (retval != 0) {
+        return retval;
+    }
+
+    ParseString(string, len, number, base);
+
+    return 0;
+}
+
+/*!
+ * \brief Format a number the way the original PrintNumerals() printed it.
+ * \param number
+ *      The number to format.
+ * \param[out] buf
+ *      The output buffer, at least SCALAR_OUTPUT_SIZE bytes.
+ * \returns
+ *      The length of the formatted string (excluding the string terminator).
+ */
+size_t ScalarFormatNumerals(uint64_t number, char *buf)
+{
+    Output = buf;
+    OutputLen = 0;
+
+    PrintNumerals(number);
+    Output[OutputLen] = '\0';
+
+    return OutputLen;
+}
+
+/*!
+ * \brief Format range values one by one, the way FormatRangeBlock() formats them.
+ * \param start
+ *      The first value of the range.
+ * \param step
+ *      The step of the range.
+ * \param first
+ *      The index of the first value to format.
+ * \param count
+ *      The number of values to format, the last one must not exceed UINT64_MAX.
+ * \param[out] buf
+ *      The output buffer, at least count * 106 bytes.
+ * \returns
+ *      The length of the formatted lines. Not terminated.
+ */
+size_t ScalarFormatRange(uint64_t start, uint64_t step, uint64_t first, uint64_t count, char *buf)
+{
+    uint64_t number = 0;
+    uint64_t i = 0;
+    size_t len = 0;
+    int bit = 0;
+
+    for (i = 0; i < count; i++) {
+        number = start + ((first + i) * step);
+        len += (size_t)sprintf(&buf[len], "%llu 0x%llx ", (unsigned long long)number,
+                               (unsigned long long)number);
+
+        /* Binary without leading zeros, but at least 1 digit. */
+        bit = 63;
+        while ((bit > 0) && (((number >> bit) & 1u) == 0)) {
+            bit--;
+        }
+        for (; bit >= 0; bit--) {
+            buf[len++] = (char)('0' + ((number >> bit) & 1u));
+        }
+        buf[len++] = 'b';
+        buf[len++] = '\n';
+    }
+
+    return len;
+}
+
+/*!
+ * \brief Convert a complete Binary or Hexadecimal digit stream the way ConvertStream() does for
+ *      seekable input.
+ * \param base
+ *      The input base, 'b' or 'h'.
+ * \param separators
+ *      The separator characters, ignored like whitespace.
+ * \param input
+ *      The input characters.
+ * \param len
+ *      The number of input characters.
+ * \param[out] output
+ *      The output, at least len * 4 + 1 bytes. Not terminated.
+ * \param[out] outputLen
+ *      The length of the output.
+ * \returns
+ *      0 in case of successful completion or -1 for an invalid character or no digits at all.
+ */
+int ScalarConvertStream(char base, const char *separators, const char *input, size_t len,
+                        char *output, size_t *outputLen)
+{
+    uint32_t value = 0;
+    uint32_t nibble = 0;
+    uint32_t nibbleBits = 0;
+    size_t digitCount = 0;
+    size_t i = 0;
+    int bit = 0;
+    char c = '\0';
+
+    /* Count the digits first to zero-pad the most significant nibble. */
+    for (i = 0; i < len; i++) {
+        c = ToLower(input[i]);
+        if ((c == '0') || (c == '1') || ((base == 'h') && (IsHexadecimalChar(c) == true))) {
+            digitCount++;
+        } else if ((strchr(" \t\r\n", c) == NULL) || (c == '\0')) {
+            if ((separators == NULL) || (c == '\0') || (strchr(separators, input[i]) == NULL)) {
+                return -1;
+            }
+        }
+    }
+    if (digitCount == 0) {
+        return -1;
+    }
+
+    *outputLen = 0;
+    nibbleBits = (uint32_t)((4u - (digitCount % 4u)) % 4u);
+    for (i = 0; i < len; i++) {
+        c = ToLower(input[i]);
+        if ((c >= '0') && (c <= '9')) {
+            value = (uint32_t)(c - '0');
+        } else if ((c >= 'a') && (c <= 'f')) {
+            value = (uint32_t)(c - 'a' + 10);
+        } else {
+            continue;
+        }
+
+        if (base == 'h') {
+            for (bit = 3; bit >= 0; bit--) {
+                output[(*outputLen)++] = (char)('0' + ((value >> bit) & 1u));
+            }
+        } else {
+            nibble = (nibble << 1) | value;
+            nibbleBits++;
+            if (nibbleBits == 4u) {
+                output[(*outputLen)++] = "0123456789abcdef"[nibble];
+                nibble = 0;
+                nibbleBits = 0;
+            }
+        }
+    }
+    output[(*outputLen)++] = '\n';
+
+    return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * This file is part of the numconvert distribution (https://github.com/baskapteijn/numconvert).
+ * Copyright (c) 2019 Bas Kapteijn.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCALAR_H__
+#define SCALAR_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SCALAR_OUTPUT_SIZE  256u
+
+int ScalarConvertString(const char *argument, size_t len, uint64_t *number);
+size_t ScalarFormatNumerals(uint64_t number, char *buf);
+size_t ScalarFormatRange(uint64_t start, uint64_t step, uint64_t first, uint64_t count, char *buf);
+int ScalarConvertStream(char base, const char *separators, const char *input, size_t len,
+                        char *output, size_t *outputLen);
+
+#endif /* SCALAR_H__ */